@@ -0,0 +1,175 @@
+#include "Campaign.h"
+
+#include "logger.h"
+#include <list>
+
+// Whether the simulator runs have the address map of the golden run (checked on the first trial,
+// then only the heap arena is checked on every run, see SimulatorRun::init)
+enum GoldenLayout {
+    LAYOUT_UNCHECKED,
+    LAYOUT_SAME,
+    LAYOUT_DIFFERENT
+};
+
+static GoldenLayout golden_layout = LAYOUT_UNCHECKED;
+
+void probe_exploded_sizes(SimulatorRun& sr, std::map<int, size_t>& sizes) {
+    // The simulator is waiting to start the scheduler: its data structures are created but not used yet
+    for (auto const& ds : sr.get_data_structures()) {
+        FaultPoint no_fault = { ds.get_id(), 0, 0, 0 };
+        Injection probe(&sr, ds, no_fault);
+        sizes[ds.get_id()] = probe.probe_exploded_size();
+        probe.close();
+    }
+}
+
+std::chrono::steady_clock::duration hang_timeout(SimulatorRun& golden) {
+    std::chrono::steady_clock::duration expected = golden.get_tolerance().get_duration_percentile(HANG_TIMEOUT_PERCENTILE);
+
+    // No reference runs: the golden run is the only sample
+    if (expected == std::chrono::steady_clock::duration::zero())
+        expected = golden.duration();
+    return expected * (100 + HANG_TIMEOUT_MARGIN_PERCENT) / 100;
+}
+
+void run_reference_runs(const std::string& sim_path, SimulatorRun& golden, int runs, std::map<int, size_t>* exploded_sizes) {
+    std::vector<SimulatorRun> refs(runs);
+    std::list<MemorySampler> samplers;
+    std::chrono::steady_clock::duration timeout = hang_timeout(golden);
+    std::error_code ec;
+
+    // Started together: they compete for the CPU as the parallel injections do
+    for (auto& ref : refs)
+        ref.init(sim_path, golden.get_workload());
+    for (auto& ref : refs) {
+        ref.start();
+        if (exploded_sizes != nullptr) {
+            samplers.emplace_back(ref, MEMORY_SAMPLER_PERIOD_MS, false);
+            samplers.back().start();
+        }
+    }
+
+    auto sampler = samplers.begin();
+    for (auto& ref : refs) {
+        bool finished = ref.wait_progressing(timeout, ec);
+
+        if (exploded_sizes != nullptr) {
+            sampler->stop();
+            sampler->get_max_exploded_sizes(*exploded_sizes);
+            sampler++;
+        }
+        if (!finished) {
+            // Not a jitter to be tolerated
+            ref.terminate();
+            LOG_F(WARNING, "Reference run (PID %lld) didn't finish in time, it is not part of the tolerance model", ref.get_pid());
+            continue;
+        }
+        if (ref.get_native_exit_code() != 0) {
+            // A crash of the workload itself, with a truncated output: not a jitter either
+            ref.discard_trace();
+            LOG_F(WARNING, "Reference run (PID %lld) exited with code %d, it is not part of the tolerance model", ref.get_pid(), ref.get_native_exit_code());
+            continue;
+        }
+        ref.save_output(nullptr);
+        ref.discard_trace();
+        golden.add_reference(ref);
+    }
+}
+
+uint64_t trigger_occurrence(SimulatorRun& golden, int hook, unsigned long time_ms) {
+    uint64_t count = golden.get_trigger_count(hook);
+    uint64_t golden_ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(golden.duration()).count();
+
+    if (count == 0)
+        return 0;
+    if (golden_ms == 0)
+        return count;
+    return std::min(count, 1 + count * time_ms / golden_ms);
+}
+
+SimulatorError run_injection_trial(const std::string& sim_path, SimulatorRun& golden, SimulatorRun& sr, FaultPoint fp, const std::string& error_pattern,
+    bool sample_memory, int trigger_hook) {
+    std::error_code ec;
+    SimulatorError se;
+
+    // Spawn a simulator instance to be injected, with the workload of the golden run, and load its data structures
+    // (the ones of the golden run once it is known that the addresses are the same)
+    sr.init(sim_path, golden.get_workload(), golden_layout == LAYOUT_SAME ? &golden : nullptr);
+    if (golden_layout == LAYOUT_UNCHECKED) {
+        golden_layout = sr.same_layout(golden) ? LAYOUT_SAME : LAYOUT_DIFFERENT;
+        if (golden_layout == LAYOUT_SAME)
+            LOG_F(INFO, "The address map matches the golden run: its data structures are reused");
+        else
+            LOG_F(INFO, "The address map can't be matched with the golden run: the data structures are read on every run");
+    }
+
+    // Retrieve the data structure to be injected
+    const DataStructure& ds = sr.get_ds_by_id(fp.struct_id);
+    Injection inj(&sr, ds, fp);
+    inj.arm_early_stop(golden.get_state_digests());
+    if (trigger_hook != TRIGGER_HOOK_NONE)
+        inj.arm_trigger(trigger_hook, trigger_occurrence(golden, trigger_hook, fp.time_ms), hang_timeout(golden));
+
+    MemorySampler sampler(sr, MEMORY_SAMPLER_PERIOD_MS);
+
+    // Signal to the simulator instance that it can start the scheduler
+    // (the handshake stays open to resume it from the trigger)
+    sr.start(inj.is_trigger_armed());
+    if (sample_memory)
+        sampler.start();
+    inj.init();
+    inj.inject(sr.get_begin_time());
+    inj.close();
+
+    // Wait for the simulator to finish (for longer if it is still making progress) and log
+    if (!inj.is_injected()) {
+        // A run without the fault would only add a masked outcome: it is not worth finishing
+        if (sr.is_running())
+            sr.terminate();
+        se = NOT_INJECTED;
+    }
+    else if (sr.wait_progressing(hang_timeout(golden), ec)) {
+        // The child exited and the timer has not expired yet
+        int native_exit_code = sr.get_native_exit_code();
+
+        // Exit codes of the reference runs are not a crash
+        if (native_exit_code && !sr.stopped_early() && !golden.get_tolerance().exit_code_seen(native_exit_code)) {
+            se = CRASH;
+        }
+        else {
+            // Child process exited with code 0 (or stopped early on a masked state) and everything should be ok
+            sr.save_output(nullptr);
+
+            // Perform comparison
+            sr.get_profile().begin(PHASE_COMPARE);
+            if (inj.has_injection_tick())
+                sr.set_injection_tick(inj.get_injection_tick());
+            se = sr.compare_with_golden(golden, error_pattern);
+
+            // The expected output, but a periodic task or timer activated later than it ever is in the golden run
+            if ((se == MASKED || se == DELAY) && sr.find_timing_violation(golden))
+                se = TIMING_VIOLATION;
+            sr.get_profile().end(PHASE_COMPARE);
+        }
+    }
+    else {
+        // The child didn't exit and stopped making progress before the timer expired (possible deadlock)
+        sr.terminate();
+        se = HANG;
+    }
+
+    sampler.stop();
+
+    // Log injection results
+    log_injection_trial(golden, sr, inj, ec, se, error_pattern);
+    if (sample_memory) {
+        sampler.print_stats(true);
+        RAW_LOG_F(INFO, "");
+    }
+
+    // The kernel trace is only worth keeping if the injection had an effect
+    if (se == MASKED || se == NOT_INJECTED)
+        sr.discard_trace();
+
+    return se;
+}
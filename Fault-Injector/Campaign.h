@@ -0,0 +1,42 @@
+#ifndef FREERTOS_FAULTINJECTOR_CAMPAIGN_H
+#define FREERTOS_FAULTINJECTOR_CAMPAIGN_H
+
+#include <map>
+#include <string>
+
+#include "SimulatorRun.h"
+#include "Injection.h"
+#include "FaultSpace.h"
+#include "MemorySampler.h"
+
+/*
+* Building blocks of an injection campaign, shared by the FaultInjector
+* and by the campaign benchmark.
+*/
+
+// Read the exploded size of every data structure of a simulator that has not started its scheduler yet.
+// The fault space is sized on the largest ones of the golden and reference runs (see MemorySampler::get_max_exploded_sizes).
+void probe_exploded_sizes(SimulatorRun& sr, std::map<int, size_t>& sizes);
+
+// Time given to a run before it is considered hung, unless it keeps reporting progress (see HANG_TIMEOUT_PERCENTILE):
+// taken from the durations of the golden and reference runs
+std::chrono::steady_clock::duration hang_timeout(SimulatorRun& golden);
+
+// Run the workload of the golden run again, in runs concurrent simulators, to learn its non-determinism
+// (the tolerance model of the golden run, used when comparing with it).
+// If exploded_sizes is given, it is raised to the largest exploded sizes seen in the reference runs.
+void run_reference_runs(const std::string& sim_path, SimulatorRun& golden, int runs, std::map<int, size_t>* exploded_sizes = nullptr);
+
+// Spawn a simulator, inject the fault point, wait for it and classify the outcome against the golden run.
+// If sample_memory is set, the data structures of the simulator are sampled for the whole run.
+// If trigger_hook is set (see trigger.h), the fault is injected at the occurrence of the hook that falls
+// at the time of the fault point in the golden run, instead of after that time. A run which doesn't reach
+// that occurrence (e.g. it diverges or ends sooner) has no fault: the trial is NOT_INJECTED.
+SimulatorError run_injection_trial(const std::string& sim_path, SimulatorRun& golden, SimulatorRun& sr, FaultPoint fp, const std::string& error_pattern,
+    bool sample_memory = false, int trigger_hook = TRIGGER_HOOK_NONE);
+
+// Occurrence of the hook at the time of the fault point in the golden run, spreading the occurrences
+// of the whole golden run over its duration (0 if the hook never occurred)
+uint64_t trigger_occurrence(SimulatorRun& golden, int hook, unsigned long time_ms);
+
+#endif //FREERTOS_FAULTINJECTOR_CAMPAIGN_H
@@ -0,0 +1,287 @@
+#include "CampaignJournal.h"
+
+#include "loguru.hpp"
+#include <string.h>
+#include <iostream>
+#include <filesystem>
+
+#if defined _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+typedef struct {
+    int64_t pid;
+    uint64_t duration_ms;
+} JournalGolden;
+
+typedef struct {
+    int32_t struct_id;
+    int32_t type;
+    uint64_t fixed_size;
+} JournalStructure;
+
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t record_checksum(const CampaignMessageHeader& header, const void* payload) {
+    uint32_t hash = fnv1a(2166136261u, &header, sizeof(header));
+    return fnv1a(hash, payload, header.length);
+}
+
+CampaignJournal::CampaignJournal() {
+    this->fp = nullptr;
+    this->unsynced_records = 0;
+    this->config_valid = false;
+    this->structure_valid = false;
+    this->golden_valid = false;
+    this->golden_pid = 0;
+    this->golden_duration_ms = 0;
+}
+
+CampaignJournal::~CampaignJournal() {
+    this->close();
+}
+
+// A new journal (an existing file is overwritten)
+void CampaignJournal::create(const std::string& path) {
+    this->path = path;
+    this->fp = fopen(path.c_str(), "wb");
+    if (this->fp == NULL) {
+        std::cerr << "Unable to open " << path << " for writing the campaign journal." << std::endl;
+        exit(1);
+    }
+    fwrite(JOURNAL_MAGIC, 1, 8, this->fp);
+    this->sync();
+}
+
+// Read the valid records of an existing journal and append to it from there.
+// Returns false if the file is not a journal.
+bool CampaignJournal::open(const std::string& path) {
+    long valid_end = 8;
+
+    if (!this->read(path, valid_end))
+        return false;
+
+    // Drop the record torn by the crash, if any
+    std::error_code ec;
+    if (fs::file_size(path, ec) != (uintmax_t)valid_end) {
+        LOG_F(WARNING, "The journal %s ends with an incomplete record: it is discarded", path.c_str());
+        fs::resize_file(path, valid_end, ec);
+    }
+
+    this->path = path;
+    this->fp = fopen(path.c_str(), "ab");
+    if (this->fp == NULL) {
+        std::cerr << "Unable to open " << path << " for appending to the campaign journal." << std::endl;
+        exit(1);
+    }
+    this->last_sync = std::chrono::steady_clock::now();
+    return true;
+}
+
+// Read the valid records of a journal without appending to it (e.g. to analyze a campaign running).
+// Returns false if the file is not a journal.
+bool CampaignJournal::load(const std::string& path) {
+    long valid_end = 8;
+
+    if (!this->read(path, valid_end))
+        return false;
+    this->path = path;
+    return true;
+}
+
+bool CampaignJournal::read(const std::string& path, long& valid_end) {
+    char magic[8];
+
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == NULL)
+        return false;
+    if (fread(magic, 1, 8, in) != 8 || memcmp(magic, JOURNAL_MAGIC, 8) != 0) {
+        fclose(in);
+        return false;
+    }
+    this->read_records(in, valid_end);
+    fclose(in);
+    return true;
+}
+
+void CampaignJournal::read_records(FILE* in, long& valid_end) {
+    CampaignMessageHeader header;
+    std::vector<char> payload;
+    uint32_t checksum;
+
+    while (fread(&header, sizeof(header), 1, in) == 1) {
+        if (header.length > JOURNAL_MAX_RECORD_LENGTH)
+            return;
+        payload.resize(header.length);
+        if (fread(payload.data(), 1, header.length, in) != header.length || fread(&checksum, sizeof(checksum), 1, in) != 1)
+            return;
+        if (checksum != record_checksum(header, payload.data()))
+            return;
+
+        if (header.type == JOURNAL_CONFIG) {
+            this->config_valid = decode_campaign_spec(payload, this->config);
+        }
+        else if (header.type == JOURNAL_GOLDEN && header.length == sizeof(JournalGolden)) {
+            JournalGolden golden;
+            memcpy(&golden, payload.data(), sizeof(golden));
+            this->golden_valid = true;
+            this->golden_pid = golden.pid;
+            this->golden_duration_ms = (unsigned long)golden.duration_ms;
+        }
+        else if (header.type == JOURNAL_STRUCTURE && header.length >= sizeof(JournalStructure)) {
+            JournalStructure structure;
+            memcpy(&structure, payload.data(), sizeof(structure));
+            this->structure_valid = true;
+            this->structure.struct_id = structure.struct_id;
+            this->structure.type = structure.type;
+            this->structure.fixed_size = structure.fixed_size;
+            this->structure.name.assign(payload.data() + sizeof(structure), header.length - sizeof(structure));
+        }
+        else if (header.type == JOURNAL_TRIAL && header.length == sizeof(TrialResult)) {
+            TrialResult result;
+            memcpy(&result, payload.data(), sizeof(result));
+            if (this->finished_trials.insert(result.index).second)
+                this->trials.push_back(result);
+        }
+
+        valid_end = ftell(in);
+    }
+}
+
+void CampaignJournal::append(uint32_t type, const void* payload, uint32_t length) {
+    CampaignMessageHeader header = { type, length };
+    uint32_t checksum = record_checksum(header, payload);
+
+    if (this->fp == nullptr)
+        return;
+    if (length > JOURNAL_MAX_RECORD_LENGTH) {
+        std::cerr << "A record of " << length << " bytes can't be written to the journal " << this->path << "." << std::endl;
+        exit(1);
+    }
+
+    fwrite(&header, sizeof(header), 1, this->fp);
+    fwrite(payload, 1, length, this->fp);
+    fwrite(&checksum, sizeof(checksum), 1, this->fp);
+
+    // Written to the OS at once (it survives the death of this process), synced to the disk in batches
+    fflush(this->fp);
+    this->unsynced_records++;
+}
+
+void CampaignJournal::sync() {
+    if (this->fp == nullptr)
+        return;
+
+    fflush(this->fp);
+#if defined _WIN32
+    _commit(_fileno(this->fp));
+#else
+    fsync(fileno(this->fp));
+#endif
+    this->unsynced_records = 0;
+    this->last_sync = std::chrono::steady_clock::now();
+}
+
+void CampaignJournal::close() {
+    if (this->fp == nullptr)
+        return;
+
+    this->sync();
+    fclose(this->fp);
+    this->fp = nullptr;
+}
+
+void CampaignJournal::write_config(const CampaignSpec& spec) {
+    std::vector<char> payload = encode_campaign_spec(spec);
+
+    this->append(JOURNAL_CONFIG, payload.data(), (uint32_t)payload.size());
+    this->sync();
+    this->config = spec;
+    this->config_valid = true;
+}
+
+void CampaignJournal::write_golden(long long pid, unsigned long duration_ms) {
+    JournalGolden golden = { (int64_t)pid, (uint64_t)duration_ms };
+
+    this->append(JOURNAL_GOLDEN, &golden, sizeof(golden));
+    this->sync();
+    this->golden_valid = true;
+    this->golden_pid = pid;
+    this->golden_duration_ms = duration_ms;
+}
+
+void CampaignJournal::write_structure(const CampaignStructure& structure) {
+    JournalStructure header = { (int32_t)structure.struct_id, (int32_t)structure.type, structure.fixed_size };
+    std::vector<char> payload(sizeof(header) + structure.name.size());
+
+    memcpy(payload.data(), &header, sizeof(header));
+    memcpy(payload.data() + sizeof(header), structure.name.data(), structure.name.size());
+    this->append(JOURNAL_STRUCTURE, payload.data(), (uint32_t)payload.size());
+    this->sync();
+    this->structure_valid = true;
+    this->structure = structure;
+}
+
+void CampaignJournal::write_trial(const TrialResult& result) {
+    this->append(JOURNAL_TRIAL, &result, sizeof(result));
+    if (this->unsynced_records >= JOURNAL_SYNC_TRIALS || std::chrono::steady_clock::now() - this->last_sync >= std::chrono::milliseconds(JOURNAL_SYNC_MS))
+        this->sync();
+
+    if (this->finished_trials.insert(result.index).second)
+        this->trials.push_back(result);
+}
+
+std::string CampaignJournal::get_path() const {
+    return this->path;
+}
+
+bool CampaignJournal::is_open() const {
+    return this->fp != nullptr;
+}
+
+bool CampaignJournal::has_config() const {
+    return this->config_valid;
+}
+
+CampaignSpec CampaignJournal::get_config() const {
+    return this->config;
+}
+
+bool CampaignJournal::has_structure() const {
+    return this->structure_valid;
+}
+
+CampaignStructure CampaignJournal::get_structure() const {
+    return this->structure;
+}
+
+bool CampaignJournal::has_golden() const {
+    return this->golden_valid;
+}
+
+long long CampaignJournal::get_golden_pid() const {
+    return this->golden_pid;
+}
+
+unsigned long CampaignJournal::get_golden_duration_ms() const {
+    return this->golden_duration_ms;
+}
+
+bool CampaignJournal::is_finished(uint64_t index) const {
+    return this->finished_trials.find(index) != this->finished_trials.end();
+}
+
+std::vector<TrialResult> CampaignJournal::get_trials() const {
+    return this->trials;
+}
@@ -0,0 +1,102 @@
+#ifndef FREERTOS_FAULTINJECTOR_CAMPAIGNJOURNAL_H
+#define FREERTOS_FAULTINJECTOR_CAMPAIGNJOURNAL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "CampaignProtocol.h"
+
+#define RESUME_ARG          "--resume"
+
+// Magic number at the beginning of a journal (8 bytes, format version included)
+#define JOURNAL_MAGIC       "FIJRNL01"
+
+// The trial records are flushed at once, but synced to the disk in batches
+#define JOURNAL_SYNC_TRIALS     16
+#define JOURNAL_SYNC_MS         1000
+
+// Longer than any record (the largest ones are the config and the structure, with their strings):
+// a longer length is read from a torn record, the valid data end before it
+#define JOURNAL_MAX_RECORD_LENGTH   65536
+
+enum JournalRecordType {
+    JOURNAL_CONFIG = 1,
+    JOURNAL_GOLDEN,
+    JOURNAL_TRIAL,
+    JOURNAL_STRUCTURE
+};
+
+// The target data structure of a campaign, to break the results down by field offline
+typedef struct {
+    int struct_id;
+    int type;
+    uint64_t fixed_size;
+    std::string name;
+} CampaignStructure;
+
+/*
+* Append-only journal of a campaign, to resume it after the master process died.
+* After the magic number, a sequence of records: type, payload length, payload and
+* the FNV-1a checksum of all of them. The payloads are:
+*   JOURNAL_CONFIG: the campaign spec (as sent to the workers, fault space key included)
+*   JOURNAL_GOLDEN: PID and duration (ms) of the golden run, whose output is in output/
+*                   (a new golden run of a resumed campaign appends a new record)
+*   JOURNAL_TRIAL:  the result of a finished trial
+*   JOURNAL_STRUCTURE: id, type and fixed size of the target data structure, followed by its name
+* A record torn by a crash fails its checksum: it is dropped, with anything after it, when the journal is opened.
+*/
+class CampaignJournal {
+private:
+    std::string path;
+    FILE* fp;
+
+    unsigned int unsynced_records;
+    std::chrono::steady_clock::time_point last_sync;
+
+    bool config_valid;
+    CampaignSpec config;
+    bool structure_valid;
+    CampaignStructure structure;
+    bool golden_valid;
+    long long golden_pid;
+    unsigned long golden_duration_ms;
+    std::set<uint64_t> finished_trials;
+    std::vector<TrialResult> trials;
+
+    void append(uint32_t type, const void* payload, uint32_t length);
+    void read_records(FILE* in, long& valid_end);
+    bool read(const std::string& path, long& valid_end);
+
+public:
+    CampaignJournal();
+    ~CampaignJournal();
+
+    void create(const std::string& path);
+    bool open(const std::string& path);
+    bool load(const std::string& path);
+    void sync();
+    void close();
+
+    void write_config(const CampaignSpec& spec);
+    void write_golden(long long pid, unsigned long duration_ms);
+    void write_structure(const CampaignStructure& structure);
+    void write_trial(const TrialResult& result);
+
+    std::string get_path() const;
+    bool is_open() const;
+    bool has_config() const;
+    CampaignSpec get_config() const;
+    bool has_structure() const;
+    CampaignStructure get_structure() const;
+    bool has_golden() const;
+    long long get_golden_pid() const;
+    unsigned long get_golden_duration_ms() const;
+    bool is_finished(uint64_t index) const;
+    std::vector<TrialResult> get_trials() const;
+};
+
+#endif //FREERTOS_FAULTINJECTOR_CAMPAIGNJOURNAL_H
@@ -0,0 +1,106 @@
+#include "CampaignProtocol.h"
+
+#include <string.h>
+
+#include "trigger.h"
+
+bool send_message(ba::ip::tcp::socket& socket, uint32_t type, const void* payload, uint32_t length) {
+    CampaignMessageHeader header = { type, length };
+    boost::system::error_code ec;
+
+    if (length > CAMPAIGN_MAX_MESSAGE_LENGTH)
+        return false;
+
+    std::vector<ba::const_buffer> buffers;
+    buffers.push_back(ba::buffer(&header, sizeof(header)));
+    if (length > 0)
+        buffers.push_back(ba::buffer(payload, length));
+
+    ba::write(socket, buffers, ec);
+    return !ec;
+}
+
+bool receive_message(ba::ip::tcp::socket& socket, uint32_t& type, std::vector<char>& payload) {
+    CampaignMessageHeader header;
+    boost::system::error_code ec;
+
+    ba::read(socket, ba::buffer(&header, sizeof(header)), ec);
+    if (ec || header.length > CAMPAIGN_MAX_MESSAGE_LENGTH)
+        return false;
+
+    type = header.type;
+    payload.resize(header.length);
+    if (header.length > 0)
+        ba::read(socket, ba::buffer(payload.data(), header.length), ec);
+    return !ec;
+}
+
+template <typename T>
+static void put(std::vector<char>& buf, T value) {
+    const char* p = (const char*)&value;
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static bool get(const std::vector<char>& buf, size_t& pos, T& value) {
+    if (pos + sizeof(T) > buf.size())
+        return false;
+    memcpy(&value, buf.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+static void put_string(std::vector<char>& buf, const std::string& s) {
+    put<uint32_t>(buf, (uint32_t)s.size());
+    buf.insert(buf.end(), s.begin(), s.end());
+}
+
+static bool get_string(const std::vector<char>& buf, size_t& pos, std::string& s) {
+    uint32_t len;
+    if (!get(buf, pos, len) || pos + len > buf.size())
+        return false;
+    s.assign(buf.data() + pos, len);
+    pos += len;
+    return true;
+}
+
+std::vector<char> encode_campaign_spec(const CampaignSpec& spec) {
+    std::vector<char> buf;
+
+    put<uint32_t>(buf, CAMPAIGN_PROTOCOL_VERSION);
+    put<int32_t>(buf, spec.struct_id);
+    put<uint64_t>(buf, spec.exploded_size);
+    put<uint64_t>(buf, spec.max_time_ms);
+    put<uint64_t>(buf, spec.key);
+    put<uint64_t>(buf, spec.trials);
+    put<int32_t>(buf, spec.sample_every);
+    put_string(buf, spec.workload);
+    put_string(buf, spec.error_pattern);
+    put<int32_t>(buf, spec.trigger_hook);
+
+    return buf;
+}
+
+bool decode_campaign_spec(const std::vector<char>& payload, CampaignSpec& spec) {
+    size_t pos = 0;
+    uint32_t version;
+    int32_t struct_id, sample_every;
+    int32_t trigger_hook = TRIGGER_HOOK_NONE;
+    uint64_t max_time_ms;
+
+    // The journals of version 1 have no trigger (the workers of a campaign have the version of their coordinator)
+    if (!get(payload, pos, version) || version < 1 || version > CAMPAIGN_PROTOCOL_VERSION)
+        return false;
+
+    bool ok = get(payload, pos, struct_id) && get(payload, pos, spec.exploded_size) && get(payload, pos, max_time_ms) &&
+        get(payload, pos, spec.key) && get(payload, pos, spec.trials) && get(payload, pos, sample_every) &&
+        get_string(payload, pos, spec.workload) && get_string(payload, pos, spec.error_pattern);
+    if (ok && version >= 2)
+        ok = get(payload, pos, trigger_hook);
+
+    spec.struct_id = struct_id;
+    spec.trigger_hook = trigger_hook;
+    spec.max_time_ms = (unsigned long)max_time_ms;
+    spec.sample_every = sample_every;
+    return ok;
+}
@@ -0,0 +1,83 @@
+#ifndef FREERTOS_FAULTINJECTOR_CAMPAIGNPROTOCOL_H
+#define FREERTOS_FAULTINJECTOR_CAMPAIGNPROTOCOL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+
+/*
+* Protocol between the coordinator of a campaign and its workers, over TCP.
+* Every message is a header (type, payload length) followed by the payload,
+* all the integers in the byte order of the hosts (the hosts of a campaign run the same build):
+*   worker -> coordinator: HELLO, GET_SHARD, RESULT
+*   coordinator -> worker: SPEC (answer to HELLO), SHARD / WAIT / DONE (answers to GET_SHARD),
+*                          RESULT_ACK (answer to RESULT, with the current end of the shard)
+* A shard is a range of trials, i.e. of fault space indexes. The coordinator can move the end of
+* a shard back while the worker runs it (work stealing): the worker stops at the end in the last ack.
+*/
+
+#define CAMPAIGN_PROTOCOL_VERSION   2
+
+// Trials of a shard when the campaign is split
+#define CAMPAIGN_SHARD_TRIALS       16
+
+// How long a worker waits before asking again for a shard, when none is left but the campaign is running
+#define CAMPAIGN_WAIT_MS            500
+
+// Longer than any message (the largest one is the spec, with its strings): a longer length
+// comes from a peer which does not speak this protocol, its connection is dropped
+#define CAMPAIGN_MAX_MESSAGE_LENGTH 65536
+
+enum CampaignMessageType {
+    MSG_HELLO = 1,
+    MSG_SPEC,
+    MSG_GET_SHARD,
+    MSG_SHARD,
+    MSG_WAIT,
+    MSG_DONE,
+    MSG_RESULT,
+    MSG_RESULT_ACK
+};
+
+typedef struct {
+    uint32_t type;
+    uint32_t length;
+} CampaignMessageHeader;
+
+// What a worker needs to run the trials of the campaign (the same fault space of the coordinator)
+typedef struct {
+    int struct_id;
+    uint64_t exploded_size;
+    unsigned long max_time_ms;
+    uint64_t key;
+    uint64_t trials;
+    int sample_every;
+    std::string workload;
+    std::string error_pattern;
+    // Kernel hook of the injections (see trigger.h), since version 2
+    int trigger_hook;
+} CampaignSpec;
+
+typedef struct {
+    uint64_t begin;
+    uint64_t end;
+} CampaignShard;
+
+typedef struct {
+    uint64_t index;
+    int32_t outcome;
+    uint32_t reserved;
+    uint64_t duration_us;
+} TrialResult;
+
+namespace ba = boost::asio;
+
+// Both return false if the connection is closed (or broken), or the message is longer than the maximum
+bool send_message(ba::ip::tcp::socket& socket, uint32_t type, const void* payload, uint32_t length);
+bool receive_message(ba::ip::tcp::socket& socket, uint32_t& type, std::vector<char>& payload);
+
+std::vector<char> encode_campaign_spec(const CampaignSpec& spec);
+bool decode_campaign_spec(const std::vector<char>& payload, CampaignSpec& spec);
+
+#endif //FREERTOS_FAULTINJECTOR_CAMPAIGNPROTOCOL_H
@@ -0,0 +1,242 @@
+#include "Coordinator.h"
+
+#include "SimulatorRun.h"
+#include "loguru.hpp"
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// How often the coordinator checks for new workers and for the end of the campaign
+#define COORDINATOR_POLL_MS     50
+
+Coordinator::Coordinator(const CampaignSpec& spec, unsigned short port, CampaignJournal* journal) {
+    this->spec = spec;
+    this->port = port;
+    this->journal = journal;
+    this->completed = 0;
+    this->connected = 0;
+    this->outcomes.assign(spec.trials, -1);
+
+    // The trials finished before the campaign was resumed
+    if (journal != nullptr) {
+        for (auto const& result : journal->get_trials()) {
+            if (result.index < spec.trials && this->outcomes[result.index] == -1) {
+                this->outcomes[result.index] = result.outcome;
+                this->outcome_counts[result.outcome]++;
+                this->completed++;
+            }
+        }
+    }
+
+    // Shards of (at most) CAMPAIGN_SHARD_TRIALS trials without a result
+    uint64_t begin = 0;
+    while (begin < spec.trials) {
+        if (this->outcomes[begin] != -1) {
+            begin++;
+            continue;
+        }
+        uint64_t end = begin;
+        while (end < spec.trials && end - begin < CAMPAIGN_SHARD_TRIALS && this->outcomes[end] == -1)
+            end++;
+        CampaignShard shard = { begin, end };
+        this->pending.push_back(shard);
+        begin = end;
+    }
+}
+
+// Returns false if there is no shard for the worker: wait is set if the campaign is not over yet
+bool Coordinator::next_shard(int worker, CampaignShard& shard, bool& wait) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    wait = false;
+    if (!this->pending.empty()) {
+        shard = this->pending.front();
+        this->pending.pop_front();
+        this->assignments[worker] = { shard.begin, shard.end };
+        return true;
+    }
+
+    // Work stealing: the trials after the running one of the largest shard in progress
+    auto victim = this->assignments.end();
+    uint64_t most = 0;
+    for (auto it = this->assignments.begin(); it != this->assignments.end(); ++it) {
+        uint64_t stealable = it->second.end > it->second.next + 1 ? it->second.end - it->second.next - 1 : 0;
+        if (it->first != worker && stealable > most) {
+            victim = it;
+            most = stealable;
+        }
+    }
+
+    if (victim != this->assignments.end()) {
+        shard.end = victim->second.end;
+        shard.begin = shard.end - (most + 1) / 2;
+        victim->second.end = shard.begin;
+        this->assignments[worker] = { shard.begin, shard.end };
+        LOG_F(INFO, "Worker %d steals the trials [%llu, %llu) of worker %d", worker, (unsigned long long)shard.begin, (unsigned long long)shard.end, victim->first);
+        return true;
+    }
+
+    this->assignments.erase(worker);
+    wait = this->completed < this->spec.trials;
+    return false;
+}
+
+// Returns the end of the shard of the worker (moved back if some trials have been stolen)
+uint64_t Coordinator::add_result(int worker, const TrialResult& result) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    // A trial of a released shard can be run twice: the first result counts
+    if (result.index < this->spec.trials && this->outcomes[result.index] == -1) {
+        this->outcomes[result.index] = result.outcome;
+        this->outcome_counts[result.outcome]++;
+        this->completed++;
+        if (this->journal != nullptr)
+            this->journal->write_trial(result);
+        LOG_F(INFO, "Injection Try #%llu / %llu: %s (worker %d, %llu ms)", (unsigned long long)result.index + 1, (unsigned long long)this->spec.trials,
+            get_outcome_name(result.outcome), worker, (unsigned long long)result.duration_us / 1000);
+    }
+
+    Assignment& a = this->assignments[worker];
+    a.next = std::max(a.next, result.index + 1);
+    return a.end;
+}
+
+// The trials of a disconnected worker without a result are run by the others
+void Coordinator::release(int worker) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    auto it = this->assignments.find(worker);
+    if (it == this->assignments.end())
+        return;
+    if (it->second.next < it->second.end) {
+        CampaignShard shard = { it->second.next, it->second.end };
+        this->pending.push_front(shard);
+        LOG_F(WARNING, "Worker %d left the trials [%llu, %llu) unfinished, they are queued again", worker, (unsigned long long)shard.begin, (unsigned long long)shard.end);
+    }
+    this->assignments.erase(it);
+}
+
+bool Coordinator::is_completed() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->completed >= this->spec.trials;
+}
+
+void Coordinator::serve(ba::ip::tcp::socket socket, int worker, std::string peer) {
+    uint32_t type;
+    std::vector<char> payload;
+    uint32_t version = 0;
+
+    this->connected++;
+
+    if (receive_message(socket, type, payload) && type == MSG_HELLO && payload.size() == sizeof(version))
+        memcpy(&version, payload.data(), sizeof(version));
+    if (version != CAMPAIGN_PROTOCOL_VERSION) {
+        LOG_F(WARNING, "Worker %d (%s) rejected: protocol version %u instead of %u", worker, peer.c_str(), version, CAMPAIGN_PROTOCOL_VERSION);
+        this->connected--;
+        return;
+    }
+
+    std::vector<char> spec_payload = encode_campaign_spec(this->spec);
+    send_message(socket, MSG_SPEC, spec_payload.data(), (uint32_t)spec_payload.size());
+    LOG_F(INFO, "Worker %d connected from %s (%d connected)", worker, peer.c_str(), this->connected.load());
+
+    while (receive_message(socket, type, payload)) {
+        if (type == MSG_GET_SHARD) {
+            CampaignShard shard;
+            bool wait;
+
+            if (this->next_shard(worker, shard, wait)) {
+                send_message(socket, MSG_SHARD, &shard, sizeof(shard));
+            }
+            else if (wait) {
+                send_message(socket, MSG_WAIT, nullptr, 0);
+            }
+            else {
+                send_message(socket, MSG_DONE, nullptr, 0);
+                break;
+            }
+        }
+        else if (type == MSG_RESULT && payload.size() == sizeof(TrialResult)) {
+            TrialResult result;
+            memcpy(&result, payload.data(), sizeof(result));
+            uint64_t end = this->add_result(worker, result);
+            send_message(socket, MSG_RESULT_ACK, &end, sizeof(end));
+        }
+        else {
+            LOG_F(WARNING, "Worker %d sent an invalid message (type %u)", worker, type);
+            break;
+        }
+    }
+
+    this->release(worker);
+    this->connected--;
+    LOG_F(INFO, "Worker %d disconnected (%d connected)", worker, this->connected.load());
+}
+
+void Coordinator::run() {
+    ba::io_context io;
+    ba::ip::tcp::acceptor acceptor(io);
+    boost::system::error_code ec;
+    int next_worker = 0;
+
+    acceptor.open(ba::ip::tcp::v4(), ec);
+    if (!ec)
+        acceptor.set_option(ba::ip::tcp::acceptor::reuse_address(true), ec);
+    if (!ec)
+        acceptor.bind(ba::ip::tcp::endpoint(ba::ip::tcp::v4(), this->port), ec);
+    if (!ec)
+        acceptor.listen(ba::socket_base::max_listen_connections, ec);
+    if (ec) {
+        std::cerr << "Unable to listen on port " << this->port << ": " << ec.message() << std::endl;
+        exit(1);
+    }
+    acceptor.non_blocking(true);
+
+    LOG_F(INFO, "Coordinator listening on port %u: %llu trials in %zu shards", this->port, (unsigned long long)this->spec.trials, this->pending.size());
+
+    // Accept workers until all the trials have a result (a worker can join at any time)
+    while (!this->is_completed()) {
+        ba::ip::tcp::socket socket(io);
+
+        acceptor.accept(socket, ec);
+        if (ec == ba::error::would_block || ec == ba::error::try_again) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(COORDINATOR_POLL_MS));
+            continue;
+        }
+        if (ec) {
+            LOG_F(WARNING, "Unable to accept a worker: %s", ec.message().c_str());
+            continue;
+        }
+
+        socket.set_option(ba::ip::tcp::no_delay(true), ec);
+        std::string peer = socket.remote_endpoint(ec).address().to_string();
+        this->workers.emplace_back(&Coordinator::serve, this, std::move(socket), next_worker++, peer);
+    }
+
+    // The remaining workers get a DONE on their next request
+    for (auto& t : this->workers)
+        t.join();
+    this->workers.clear();
+}
+
+void Coordinator::print_stats(bool use_logger) {
+    using namespace std;
+
+    stringstream ss;
+
+    ss << "Campaign results (" << this->completed << " / " << this->spec.trials << " trials):\n";
+    for (int se = MASKED; se <= TIMING_VIOLATION; se++)
+        ss << left << setw(28) << get_outcome_name(se) << right << setw(10) << this->outcome_counts[se] << "\n";
+    // Finished, but without a fault: not an outcome
+    ss << left << setw(28) << get_outcome_name(NOT_INJECTED) << right << setw(10) << this->outcome_counts[NOT_INJECTED] << " (left out)\n";
+
+    if (use_logger) {
+        RAW_LOG_F(INFO, "%s", ss.str().c_str());
+    }
+    else {
+        cout << ss.str() << endl;
+    }
+}
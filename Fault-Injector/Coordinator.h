@@ -0,0 +1,61 @@
+#ifndef FREERTOS_FAULTINJECTOR_COORDINATOR_H
+#define FREERTOS_FAULTINJECTOR_COORDINATOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CampaignProtocol.h"
+#include "CampaignJournal.h"
+
+#define COORDINATOR_ARG     "--coordinator"
+
+/*
+* Serves the trials of a campaign to the workers connected over TCP (see CampaignProtocol.h).
+* The trials are split in shards handed out on request; once none is left, an idle worker
+* steals the second half of the trials not started yet of the largest shard in progress.
+* The shard of a worker which disconnects goes back to the queue from its first trial without a result.
+* The results are written to the journal of the campaign, whose finished trials are not served again.
+*/
+class Coordinator {
+private:
+    CampaignSpec spec;
+    unsigned short port;
+    CampaignJournal* journal;
+
+    // Shard in progress on a worker: the next trial without a result (the one running) and the end
+    typedef struct {
+        uint64_t next;
+        uint64_t end;
+    } Assignment;
+
+    std::mutex lock;
+    std::deque<CampaignShard> pending;
+    std::map<int, Assignment> assignments;
+    std::vector<int> outcomes;
+    uint64_t completed;
+    std::map<int, int> outcome_counts;
+    std::atomic<int> connected;
+
+    std::vector<std::thread> workers;
+
+    bool next_shard(int worker, CampaignShard& shard, bool& wait);
+    uint64_t add_result(int worker, const TrialResult& result);
+    void release(int worker);
+    bool is_completed();
+    void serve(ba::ip::tcp::socket socket, int worker, std::string peer);
+
+public:
+    Coordinator(const CampaignSpec& spec, unsigned short port, CampaignJournal* journal = nullptr);
+
+    void run();
+
+    void print_stats(bool use_logger);
+};
+
+#endif //FREERTOS_FAULTINJECTOR_COORDINATOR_H
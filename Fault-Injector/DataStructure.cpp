@@ -2,6 +2,8 @@
 
 #include "memory_logger.h"
 
+#include <algorithm>
+
 DataStructure::DataStructure(int id, const char* name, int type, void* address) {
 	this->id = id;
 	this->name = name;
@@ -19,11 +21,15 @@ size_t DataStructure::get_fixed_size() const {
 	return this->fixed_size;
 }
 
-size_t DataStructure::get_exploded_size() const {
+size_t DataStructure::get_exploded_size(const char* struct_before) const {
 	return get_exploded_sizeof_struct(type, (void*)struct_before);
 }
 
-void DataStructure::get_next_expansion(size_t byte_number, void** byte_to_inject, void** addr_to_read, size_t* size_to_read) const {
+size_t DataStructure::get_struct_before_size() const {
+	return std::min(this->fixed_size, (size_t)STRUCT_BEFORE_SIZE);
+}
+
+void DataStructure::get_next_expansion(const char* struct_before, size_t byte_number, void** byte_to_inject, void** addr_to_read, size_t* size_to_read) const {
 	get_next_expansion_struct(type, (void*)struct_before, byte_number, byte_to_inject, addr_to_read, size_to_read);
 }
 
@@ -41,6 +47,38 @@ void* DataStructure::get_address() const {
 	return this->address;
 }
 
-char* DataStructure::get_struct_before() {
-	return this->struct_before;
+void DataStructureTable::add(const DataStructure& ds) {
+	int id = ds.get_id();
+
+	if (id >= 0) {
+		if ((size_t)id >= this->positions.size())
+			this->positions.resize(id + 1, -1);
+		this->positions[id] = (int)this->structures.size();
+	}
+	this->structures.push_back(ds);
+}
+
+void DataStructureTable::add_symbol(const std::string& name, void* address) {
+	this->symbols[name] = address;
+}
+
+const std::vector<DataStructure>& DataStructureTable::get_structures() const {
+	return this->structures;
+}
+
+const std::map<std::string, void*>& DataStructureTable::get_symbols() const {
+	return this->symbols;
+}
+
+const DataStructure* DataStructureTable::find(int id) const {
+	if (id < 0 || (size_t)id >= this->positions.size() || this->positions[id] == -1)
+		return nullptr;
+	return &this->structures[this->positions[id]];
+}
+
+void* DataStructureTable::get_symbol(const std::string& name) const {
+	auto it = this->symbols.find(name);
+	if (it == this->symbols.end())
+		return nullptr;
+	return it->second;
 }
\ No newline at end of file
@@ -9,8 +9,13 @@
 
 #include <string>
 #include <iostream>
+#include <map>
+#include <vector>
 #include "FreeRTOSInterface.h"
 
+// Bytes of a data structure read before the injection (larger structures, e.g. the heap arena, are read partially)
+#define STRUCT_BEFORE_SIZE	500
+
 class DataStructure {
 private:
 	int id;
@@ -19,21 +24,41 @@ private:
 	void *address;
 	size_t fixed_size;
 
-	char struct_before[500];
-
 public:
     DataStructure(int id, const char* name, int type, void* address);
 
 	size_t get_fixed_size() const;
-	size_t get_exploded_size() const;
-	void get_next_expansion(size_t byte_number, void** byte_to_inject, void** addr_to_read, size_t* size_to_read) const;
+	// The exploded part is found through a copy of the structure (get_struct_before_size() bytes) read by the injector
+	size_t get_exploded_size(const char* struct_before) const;
+	size_t get_struct_before_size() const;
+	void get_next_expansion(const char* struct_before, size_t byte_number, void** byte_to_inject, void** addr_to_read, size_t* size_to_read) const;
 	int get_id() const;
 	std::string get_name() const;
 	int get_type() const;
 	void* get_address() const;
-	char* get_struct_before();
 
     friend std::ostream& operator<<(std::ostream& output, const DataStructure& ds);
 };
 
+/*
+* The data structures logged by a simulator, indexed by id, and the kernel symbols it exports.
+* The runs with the same address map share a single table (see SimulatorRun::init()).
+*/
+class DataStructureTable {
+private:
+	std::vector<DataStructure> structures;
+	// Position in structures of the structure with the id (-1: none)
+	std::vector<int> positions;
+	std::map<std::string, void*> symbols;
+
+public:
+	void add(const DataStructure& ds);
+	void add_symbol(const std::string& name, void* address);
+
+	const std::vector<DataStructure>& get_structures() const;
+	const std::map<std::string, void*>& get_symbols() const;
+	const DataStructure* find(int id) const;
+	void* get_symbol(const std::string& name) const;
+};
+
 #endif //FREERTOS_FAULTINJECTOR_DATASTRUCTURE_H
\ No newline at end of file
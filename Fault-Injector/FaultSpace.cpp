@@ -0,0 +1,122 @@
+#include "FaultSpace.h"
+
+#include <iostream>
+
+FaultSpace::FaultSpace() {
+    this->struct_offsets.push_back(0);
+    this->time_buckets = 0;
+    this->total_size = 0;
+    this->key = 0;
+    this->half_bits = 1;
+    this->half_mask = 1;
+}
+
+void FaultSpace::add_structure(int struct_id, size_t size_bytes) {
+    // The number of points is only known after init(), here we just record the byte sizes
+    this->struct_ids.push_back(struct_id);
+    this->struct_offsets.push_back(this->struct_offsets.back() + size_bytes);
+}
+
+void FaultSpace::init(unsigned long max_time_ms, uint64_t key) {
+    this->key = key;
+    this->time_buckets = max_time_ms / FAULT_SPACE_TIME_BUCKET_MS;
+    if (this->time_buckets == 0)
+        this->time_buckets = 1;
+
+    // Convert the byte offsets into point offsets (8 bits per byte, one point per bit per bucket)
+    for (auto& offset : this->struct_offsets)
+        offset *= 8 * this->time_buckets;
+    this->total_size = this->struct_offsets.back();
+
+    // The Feistel network works on 2 * half_bits bits: take the smallest even width covering the space
+    unsigned int bits = 0;
+    while (bits < 64 && (1ULL << bits) < this->total_size)
+        bits++;
+    this->half_bits = bits < 2 ? 1 : (bits + 1) / 2;
+    this->half_mask = (1ULL << this->half_bits) - 1;
+}
+
+uint64_t FaultSpace::size() const {
+    return this->total_size;
+}
+
+uint64_t FaultSpace::round_function(uint64_t value, unsigned int round) const {
+    // splitmix64 finalizer over the key, the round and the half block
+    uint64_t z = value + this->key + 0x9E3779B97F4A7C15ULL * (round + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return z & this->half_mask;
+}
+
+uint64_t FaultSpace::feistel(uint64_t index) const {
+    uint64_t left = (index >> this->half_bits) & this->half_mask;
+    uint64_t right = index & this->half_mask;
+
+    for (unsigned int r = 0; r < FAULT_SPACE_FEISTEL_ROUNDS; r++) {
+        uint64_t tmp = right;
+        right = left ^ this->round_function(right, r);
+        left = tmp;
+    }
+
+    return (left << this->half_bits) | right;
+}
+
+uint64_t FaultSpace::permute(uint64_t index) const {
+    // Cycle-walking: the Feistel network is a bijection on [0, 2^(2*half_bits)),
+    // iterating it until we fall back in [0, size) gives a bijection on [0, size)
+    uint64_t p = this->feistel(index);
+    while (p >= this->total_size)
+        p = this->feistel(p);
+    return p;
+}
+
+FaultPoint FaultSpace::at(uint64_t index) const {
+    FaultPoint fp;
+
+    if (index >= this->total_size) {
+        std::cerr << "Error: fault space index " << index << " out of range (size " << this->total_size << ")." << std::endl;
+        exit(2);
+    }
+
+    uint64_t p = this->permute(index);
+
+    // Find the structure owning this point
+    size_t s = 0;
+    while (p >= this->struct_offsets[s + 1])
+        s++;
+    p -= this->struct_offsets[s];
+
+    fp.struct_id = this->struct_ids[s];
+    fp.time_ms = (unsigned long)(p % this->time_buckets) * FAULT_SPACE_TIME_BUCKET_MS;
+    p /= this->time_buckets;
+    fp.bit = (unsigned short)(p % 8);
+    fp.byte = (size_t)(p / 8);
+
+    return fp;
+}
+
+FaultSpace::Shard FaultSpace::shard(uint64_t shard_id, uint64_t shard_count) const {
+    return Shard(this, shard_id, shard_count);
+}
+
+FaultSpace::Shard::Shard(const FaultSpace* space, uint64_t shard_id, uint64_t shard_count) {
+    this->space = space;
+    this->shard_id = shard_id;
+    this->shard_count = shard_count > 0 ? shard_count : 1;
+}
+
+uint64_t FaultSpace::Shard::size() const {
+    uint64_t total = this->space->size();
+    if (this->shard_id >= total)
+        return 0;
+    return (total - this->shard_id + this->shard_count - 1) / this->shard_count;
+}
+
+uint64_t FaultSpace::Shard::global_index(uint64_t index) const {
+    return this->shard_id + index * this->shard_count;
+}
+
+FaultPoint FaultSpace::Shard::at(uint64_t index) const {
+    return this->space->at(this->global_index(index));
+}
@@ -0,0 +1,71 @@
+#ifndef FREERTOS_FAULTINJECTOR_FAULTSPACE_H
+#define FREERTOS_FAULTINJECTOR_FAULTSPACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Width (in ms) of a time bucket of the fault space
+#define FAULT_SPACE_TIME_BUCKET_MS      1
+
+// Number of Feistel rounds used by the keyed permutation
+#define FAULT_SPACE_FEISTEL_ROUNDS      6
+
+// A single point of the fault space: which bit of which byte of which structure, and when
+typedef struct {
+    int struct_id;
+    size_t byte;
+    unsigned short bit;
+    unsigned long time_ms;
+} FaultPoint;
+
+/*
+* The fault space is the cartesian product (structure, byte, bit, time bucket).
+* Each point is identified by an index in [0, size()), which is mapped to the
+* actual point through a keyed permutation: walking the indexes in order visits
+* every point exactly once (sampling without replacement) in a pseudo-random order
+* that only depends on the key.
+* A shard k of n takes the indexes k, k + n, k + 2n, ... so the shards are disjoint.
+*/
+class FaultSpace {
+private:
+    std::vector<int> struct_ids;
+    std::vector<uint64_t> struct_offsets;
+    uint64_t time_buckets;
+    uint64_t total_size;
+
+    uint64_t key;
+    unsigned int half_bits;
+    uint64_t half_mask;
+
+    uint64_t round_function(uint64_t value, unsigned int round) const;
+    uint64_t feistel(uint64_t index) const;
+    uint64_t permute(uint64_t index) const;
+
+public:
+    FaultSpace();
+
+    void add_structure(int struct_id, size_t size_bytes);
+    void init(unsigned long max_time_ms, uint64_t key);
+
+    uint64_t size() const;
+    FaultPoint at(uint64_t index) const;
+
+    class Shard {
+    private:
+        const FaultSpace* space;
+        uint64_t shard_id;
+        uint64_t shard_count;
+
+    public:
+        Shard(const FaultSpace* space, uint64_t shard_id, uint64_t shard_count);
+
+        uint64_t size() const;
+        uint64_t global_index(uint64_t index) const;
+        FaultPoint at(uint64_t index) const;
+    };
+
+    Shard shard(uint64_t shard_id, uint64_t shard_count) const;
+};
+
+#endif //FREERTOS_FAULTINJECTOR_FAULTSPACE_H
@@ -1,3 +1,5 @@
+#include <stdio.h>
+
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
@@ -6,6 +8,7 @@
 #include "event_groups.h"
 #include "stream_buffer.h"
 #include "memory_logger.h"
+#include "FreeRTOSInterface.h"
 
 size_t get_fixed_sizeof_struct(int type) {
 	if (type == TYPE_TASK_HANDLE) {
@@ -41,6 +44,13 @@ size_t get_fixed_sizeof_struct(int type) {
 	else if (type == TYPE_LIST) {
 		return getList_FixedSize();
 	}
+	else if (type == TYPE_HEAP_ARENA) {
+		return configTOTAL_HEAP_SIZE;
+	}
+	else if (type == TYPE_TASK_STACK) {
+		// The TCB, which leads to the thread data of the task
+		return getTCB_FixedSize();
+	}
 
 	return 0;
 }
@@ -80,6 +90,12 @@ size_t get_exploded_sizeof_struct(int type, void* ds) {
 		// TODO: expanded?
 		return getList_CurrentExplodedSize((List_t *)ds);
 	}
+	else if (type == TYPE_HEAP_ARENA) {
+		return configTOTAL_HEAP_SIZE;
+	}
+	else if (type == TYPE_TASK_STACK) {
+		return TASK_STACK_FAULT_SPACE_SIZE;
+	}
 
 	return 0;
 }
@@ -108,6 +124,97 @@ void get_next_expansion_struct(int type, void* ds, size_t byte_number, void** by
 	}
 }
 
+size_t get_sizeof_tick_type(void) {
+	return sizeof(TickType_t);
+}
+
+size_t get_task_thread_size(void) {
+	return xPortGetThreadSize();
+}
+
+// tcb is a local copy of the TCB: pxTopOfStack is its first member
+void* get_task_thread_address(void* tcb) {
+	return pvPortGetThreadAddress(*(void**)tcb);
+}
+
+// thread is a local copy of the thread data, the bounds are addresses of the simulator
+void get_task_live_stack(void* thread, void** low, void** high) {
+	vPortGetThreadLiveStack(thread, low, high);
+}
+
+static const FieldLayout* find_field(const FieldLayout* fields, size_t count, size_t byte) {
+	for (size_t i = 0; i < count; i++) {
+		if (byte >= fields[i].offset && byte < fields[i].offset + fields[i].size)
+			return &fields[i];
+	}
+	return NULL;
+}
+
+// The field of a data structure at a byte of its fixed part (the fields of the embedded lists are resolved too).
+// Returns 0 if the byte is not in a field (padding) or the structure has no field layout.
+int get_struct_field(int type, size_t byte, char* name, size_t name_size, int* kind) {
+	const FieldLayout* fields = NULL;
+	const FieldLayout* field = NULL;
+	size_t count = 0;
+
+	if (type == TYPE_TASK_HANDLE)
+		fields = getTCB_Fields(&count);
+	else if (type == TYPE_QUEUE_HANDLE || type == TYPE_QUEUE_SET_HANDLE)
+		fields = getQueue_Fields(&count);
+	else if (type == TYPE_SEMAPHORE_HANDLE || type == TYPE_COUNT_SEMAPHORE) {
+		// The union of the queue is the semaphore data
+		fields = getSemaphore_UnionFields(&count);
+		field = find_field(fields, count, byte);
+		fields = getQueue_Fields(&count);
+	}
+	else if (type == TYPE_TIMER_HANDLE)
+		fields = getTimer_Fields(&count);
+	else if (type == TYPE_EVENT_GROUP_HANDLE)
+		fields = getEventGroup_Fields(&count);
+	else if (type == TYPE_MESSAGE_BUFFER_HANDLE || type == TYPE_STREAM_BUFFER_HANDLE)
+		fields = getStreamBuffer_Fields(&count);
+	else if (type == TYPE_LIST)
+		fields = getList_Fields(&count);
+
+	if (field == NULL && fields != NULL)
+		field = find_field(fields, count, byte);
+	if (field == NULL)
+		return 0;
+
+	if (field->kind == FIELD_KIND_LIST || field->kind == FIELD_KIND_LIST_ITEM) {
+		const FieldLayout* list_fields = field->kind == FIELD_KIND_LIST ? getList_Fields(&count) : getListItem_Fields(&count);
+		const FieldLayout* list_field = find_field(list_fields, count, byte - field->offset);
+		if (list_field != NULL) {
+			snprintf(name, name_size, "%s.%s", field->name, list_field->name);
+			*kind = list_field->kind;
+			return 1;
+		}
+	}
+
+	snprintf(name, name_size, "%s", field->name);
+	*kind = field->kind;
+	return 1;
+}
+
+const char* get_field_kind_name(int kind) {
+	switch (kind) {
+	case FIELD_KIND_POINTER:
+		return "pointer";
+	case FIELD_KIND_COUNTER:
+		return "counter";
+	case FIELD_KIND_FLAG:
+		return "flag";
+	case FIELD_KIND_LIST:
+		return "list";
+	case FIELD_KIND_LIST_ITEM:
+		return "list item";
+	case FIELD_KIND_VALUE:
+		return "value";
+	default:
+		return "unknown";
+	}
+}
+
 void test_print(void* addr) {
 	printQueueFields((QueueHandle_t)addr);
 }
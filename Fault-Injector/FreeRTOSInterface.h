@@ -9,6 +9,12 @@
 * Therefore, it is required to have control over the data structures to be injected.
 */
 
+/*
+* A task stack is reached through the TCB of the task and only its live part is a target:
+* the fault space byte is folded on the live part at injection time.
+*/
+#define TASK_STACK_FAULT_SPACE_SIZE		4096
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +22,12 @@ extern "C" {
 	size_t get_fixed_sizeof_struct(int type);
 	size_t get_exploded_sizeof_struct(int type, void* ds);
 	void get_next_expansion_struct(int type, void* ds, size_t byte_number, void** byte_to_inject, void** addr_to_read, size_t* size_to_read);
+	size_t get_sizeof_tick_type(void);
+	size_t get_task_thread_size(void);
+	void* get_task_thread_address(void* tcb);
+	void get_task_live_stack(void* thread, void** low, void** high);
+	int get_struct_field(int type, size_t byte, char* name, size_t name_size, int* kind);
+	const char* get_field_kind_name(int kind);
 	void test_print(void *addr);
 
 #ifdef __cplusplus
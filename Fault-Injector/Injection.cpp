@@ -2,6 +2,7 @@
 
 #include "loguru.hpp"
 #include <string.h>
+#include <stddef.h>
 #include <sstream>
 
 #if defined __unix__
@@ -21,12 +22,25 @@
 
 #include "FreeRTOSInterface.h"
 
-Injection::Injection(SimulatorRun* sr, DataStructure ds, unsigned long max_time_ms) : ds(ds) {
+Injection::Injection(SimulatorRun* sr, const DataStructure& ds, FaultPoint fault_point) : ds(ds) {
     this->sr = sr;
     this->pid = sr->get_pid();
-	this->max_time_ms = max_time_ms;
-	this->random_time_ms = rand() % max_time_ms;
-    this->target_bit_number = rand() % 8;
+    this->fault_point = fault_point;
+	this->random_time_ms = fault_point.time_ms;
+    this->target_bit_number = fault_point.bit;
+    this->injected_byte_addr = nullptr;
+    this->exploded_size = 0;
+    this->early_stop_armed = false;
+    this->injected = false;
+    this->trigger_hook = TRIGGER_HOOK_NONE;
+    this->trigger_occurrence = 0;
+    this->trigger_reached = false;
+    this->byte_buffer_before = 0;
+    this->byte_buffer_after = 0;
+    this->target_byte_number = 0;
+    this->injection_tick_valid = false;
+    this->injection_tick = 0;
+    memset(this->struct_before, 0, sizeof(this->struct_before));
 
 #if defined __linux__
     this->linux_pid = pid;
@@ -51,6 +65,66 @@ void Injection::init() {
 
 }
 
+size_t Injection::probe_exploded_size() {
+    // Structures not allocated yet (e.g. created by the scheduler) only have their fixed size
+    if (ds.get_address() == nullptr)
+        return ds.get_fixed_size();
+    // No stack is live yet: the live stacks are sized by sampling the runs (see MemorySampler)
+    if (ds.get_type() == TYPE_TASK_STACK)
+        return 0;
+
+    read_memory(ds.get_address(), struct_before, ds.get_struct_before_size());
+    return ds.get_exploded_size(struct_before);
+}
+
+void Injection::arm_early_stop(const std::vector<uint64_t>& golden_digests) {
+    void* golden_addr = sr->get_symbol(STATE_DIGEST_SYM_GOLDEN);
+    void* count_addr = sr->get_symbol(STATE_DIGEST_SYM_GOLDEN_COUNT);
+
+    if (golden_addr == nullptr || count_addr == nullptr || golden_digests.empty())
+        return;
+
+    // The digest covers the fixed part of the logged structures only: a fault anywhere else
+    // could be masked in the digest but still be there
+    if (ds.get_type() == TYPE_STATIC_STACK || ds.get_type() == TYPE_TASK_STACK || ds.get_type() == TYPE_HEAP_ARENA || fault_point.byte >= ds.get_fixed_size())
+        return;
+
+    uint32_t count = (uint32_t)std::min(golden_digests.size(), (size_t)STATE_DIGEST_MAX_CYCLES);
+    std::vector<uint64_t> digests(golden_digests.begin(), golden_digests.begin() + count);
+
+    write_memory(golden_addr, (char*)digests.data(), count * sizeof(uint64_t));
+    write_memory(count_addr, (char*)&count, sizeof(count));
+    early_stop_armed = true;
+}
+
+// The simulator stops at the occurrence of the hook (counted from 1) and waits there for the injection, for at most
+// timeout from its start. False if the simulator doesn't export its trigger table: the injection is after the time of the fault point
+bool Injection::arm_trigger(int hook, uint64_t occurrence, std::chrono::steady_clock::duration timeout) {
+#if defined _WIN32
+    // There is no handshake pipe to stop and resume the simulator
+    return false;
+#else
+    void* table_addr = sr->get_symbol(TRIGGER_SYM_TABLE);
+
+    if (table_addr == nullptr || hook <= TRIGGER_HOOK_NONE || hook >= TRIGGER_HOOK_COUNT || occurrence == 0)
+        return false;
+
+    TriggerTable armed = {};
+    armed.armed_hook = (uint32_t)hook;
+    armed.armed_occurrence = occurrence;
+    write_memory(table_addr, (char*)&armed, offsetof(TriggerTable, counts));
+
+    this->trigger_hook = hook;
+    this->trigger_occurrence = occurrence;
+    this->trigger_timeout = timeout;
+    return true;
+#endif
+}
+
+bool Injection::is_trigger_armed() const {
+    return this->trigger_hook != TRIGGER_HOOK_NONE;
+}
+
 void Injection::close() {
 #if defined _WIN32
     if (handle_open) {
@@ -62,41 +136,67 @@ void Injection::close() {
 
 void Injection::inject(std::chrono::steady_clock::time_point begin_time) {
     // Wait
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin_time).count();
-    std::this_thread::sleep_for(std::chrono::milliseconds(random_time_ms - ms));
+    sr->get_profile().begin(PHASE_WAIT_INJECT);
+    if (is_trigger_armed()) {
+        // The simulator stops at the hook: its kernel state is the same as long as the injection lasts
+        trigger_reached = sr->wait_trigger(begin_time + trigger_timeout);
+    }
+    else {
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin_time).count();
+        if ((long long)random_time_ms > ms)
+            std::this_thread::sleep_for(std::chrono::milliseconds(random_time_ms - ms));
+    }
+    sr->get_profile().end(PHASE_WAIT_INJECT);
 
     // Injection
     // Check if the Simulator is still running (it may have crashed in the meanwhile..)
-    // However, in a normal situation, theoretically a non-injected simulator should not crash
-    if (!sr->is_running())
+    // However, in a normal situation, theoretically a non-injected simulator should not crash.
+    // With a trigger, the run may also end (or hang) before the occurrence: nothing is injected then,
+    // and the trial is not an outcome (see NOT_INJECTED)
+    if (!sr->is_running() || (is_trigger_armed() && !trigger_reached)) {
+        sr->resume();
         return;
+    }
 
     // 1. Read phase
     // Read the entire data structure
-    char* struct_before = ds.get_struct_before();
-    read_memory(ds.get_address(), struct_before, ds.get_fixed_size());
+    sr->get_profile().begin(PHASE_READ_WRITE_MEMORY);
+    read_memory(ds.get_address(), struct_before, ds.get_struct_before_size());
     //std::cout << "Before injection queue:" << std::endl;
     //std::cout << "----------------------" << std::endl;
     //test_print(struct_before);
+    if (ds.get_type() == TYPE_TASK_STACK) {
+        // Only the live part of the stack of the task is a target
+        this->locate_live_stack_byte(struct_before);
+    }
+    else {
     // Get the exploded data structure size (including items stored in lists etc.)
-    exploded_size = ds.get_exploded_size();
+    exploded_size = ds.get_exploded_size(struct_before);
 
-    // Next, generate a random number in the virtual exploded size space
-    target_byte_number = rand() % exploded_size;
+    // Next, take the byte of the fault point in the virtual exploded size space
+    // (the space has been sized on the largest instance seen: a byte beyond this one is not there, nothing to inject)
+    target_byte_number = fault_point.byte;
 
     // Then, analyze FreeRTOS data structure to check where we are pointing with our random byte number:
     //  1: If we are pointing to a field which does not need any expansion, we select this byte for the injeciton;
     //  2: If we are pointing to a field in the expanded space, we need to follow some pointers to retrieve the real byte address to inject
-    if (target_byte_number < ds.get_fixed_size()) {
+    if (target_byte_number >= exploded_size) {
+        injected_byte_addr = nullptr;
+        byte_buffer_before = 0;
+    }
+    else if (target_byte_number < ds.get_fixed_size()) {
         // 1
         injected_byte_addr = (void *)( (char*)ds.get_address() + target_byte_number );
-        byte_buffer_before = struct_before[target_byte_number];
+        if (target_byte_number < ds.get_struct_before_size())
+            byte_buffer_before = struct_before[target_byte_number];
+        else
+            read_memory(injected_byte_addr, &byte_buffer_before, 1);
     }
     else {
         // 2
         void* addr_to_read;
         size_t size_to_read;
-        ds.get_next_expansion(target_byte_number - ds.get_fixed_size(), &injected_byte_addr, &addr_to_read, &size_to_read);
+        ds.get_next_expansion(struct_before, target_byte_number - ds.get_fixed_size(), &injected_byte_addr, &addr_to_read, &size_to_read);
         if (addr_to_read == NULL) {
             read_memory(injected_byte_addr, &byte_buffer_before, 1);
         }
@@ -104,12 +204,36 @@ void Injection::inject(std::chrono::steady_clock::time_point begin_time) {
             // TODO (deeper linking)
         }
     }
+    }
 
     // 2. Flip phase
     byte_buffer_after = byte_buffer_before ^ (1 << target_bit_number);
 
     // 3. Write phase
-    write_memory(injected_byte_addr, &byte_buffer_after, 1);
+    if (injected_byte_addr != nullptr) {
+        write_memory(injected_byte_addr, &byte_buffer_after, 1);
+        injected = true;
+    }
+
+    // 4. Let the simulator compare its state with the golden one from now on
+    if (early_stop_armed) {
+        uint32_t injection_done = 1;
+        write_memory(sr->get_symbol(STATE_DIGEST_SYM_INJECTED), (char*)&injection_done, sizeof(injection_done));
+    }
+
+    // 5. Read the tick at which the fault has been injected, to measure its latency
+    void* tick_addr = sr->get_symbol("TickCount");
+    if (tick_addr != nullptr && get_sizeof_tick_type() <= sizeof(unsigned long)) {
+        unsigned long tick = 0;
+        read_memory(tick_addr, (char*)&tick, get_sizeof_tick_type());
+        injection_tick = tick;
+        injection_tick_valid = true;
+    }
+
+    // 6. Let the simulator go on from the hook
+    if (is_trigger_armed())
+        sr->resume();
+    sr->get_profile().end(PHASE_READ_WRITE_MEMORY);
 
     //char struct_after[500];
     //read_memory(ds.get_address(), struct_after, ds.get_fixed_size());
@@ -125,36 +249,106 @@ void Injection::print_stats(bool use_logger) {
     
     stringstream ss;
 
+    // Field of the fixed part hit by the fault (stacks and the heap arena have no field layout)
+    char field_name[128];
+    int field_kind = 0;
+    bool has_field = ds.get_type() != TYPE_STATIC_STACK && ds.get_type() != TYPE_TASK_STACK && ds.get_type() != TYPE_HEAP_ARENA &&
+        target_byte_number < ds.get_fixed_size() && get_struct_field(ds.get_type(), target_byte_number, field_name, sizeof(field_name), &field_kind);
+
     if (use_logger) {
         RAW_LOG_F(INFO, "Injection stats:");
         ss.clear();
         ss << ds;
         RAW_LOG_F(INFO, "Injected data structure: %s", ss.str().c_str());
         RAW_LOG_F(INFO, "Target data structure size (bytes): %d", ds.get_fixed_size());
-        RAW_LOG_F(INFO, "Target data structure expanded size (bytes): %d", ds.get_exploded_size());
+        RAW_LOG_F(INFO, "Target data structure expanded size (bytes): %d", ds.get_exploded_size(struct_before));
+        if (ds.get_type() == TYPE_TASK_STACK)
+            RAW_LOG_F(INFO, "Live stack size (bytes): %lu", (unsigned long)exploded_size);
         RAW_LOG_F(INFO, "Target byte: %d", target_byte_number);
+        if (has_field)
+            RAW_LOG_F(INFO, "Target field: %s (%s)", field_name, get_field_kind_name(field_kind));
         RAW_LOG_F(INFO, "Target bit: %d", target_bit_number);
         RAW_LOG_F(INFO, "Byte value as unsigned integer before injection: %u", (unsigned int)byte_buffer_before);
         RAW_LOG_F(INFO, "Byte value as unsigned integer after injection: %u", (unsigned int)byte_buffer_after);
-        RAW_LOG_F(INFO, "Performed after %lu ms from the start of the FreeRTOS simulator scheduler", random_time_ms);
+        if (!is_trigger_armed())
+            RAW_LOG_F(INFO, "Performed after %lu ms from the start of the FreeRTOS simulator scheduler", random_time_ms);
+        else if (trigger_reached)
+            RAW_LOG_F(INFO, "Performed at the occurrence %llu of the hook %s (the one of %lu ms in the golden run)", (unsigned long long)trigger_occurrence, get_trigger_hook_name(trigger_hook), random_time_ms);
+        else
+            RAW_LOG_F(INFO, "Not performed: the occurrence %llu of the hook %s has not been reached", (unsigned long long)trigger_occurrence, get_trigger_hook_name(trigger_hook));
+        if (injection_tick_valid)
+            RAW_LOG_F(INFO, "Performed at tick %lu", injection_tick);
     }
     else {
         cout << "Injection stats:\n";
         cout << "Injected data structure: " << ds << "\n";
         cout << "Target data structure size (bytes): " << ds.get_fixed_size() << "\n";
-        cout << "Target data structure expanded size (bytes): " << ds.get_exploded_size() << "\n";
+        cout << "Target data structure expanded size (bytes): " << ds.get_exploded_size(struct_before) << "\n";
+        if (ds.get_type() == TYPE_TASK_STACK)
+            cout << "Live stack size (bytes): " << exploded_size << "\n";
         cout << "Target byte: " << target_byte_number << "\n";
+        if (has_field)
+            cout << "Target field: " << field_name << " (" << get_field_kind_name(field_kind) << ")\n";
         cout << "Target bit: " << target_bit_number << "\n";
         cout << "Byte value as unsigned integer before injection: " << (unsigned int)byte_buffer_before << "\n";
         cout << "Byte value as unsigned integer after injection: " << (unsigned int)byte_buffer_after << "\n";
-        cout << "Performed after " << random_time_ms << " ms from the start of the FreeRTOS simulator scheduler" << endl;
+        if (!is_trigger_armed())
+            cout << "Performed after " << random_time_ms << " ms from the start of the FreeRTOS simulator scheduler" << endl;
+        else if (trigger_reached)
+            cout << "Performed at the occurrence " << trigger_occurrence << " of the hook " << get_trigger_hook_name(trigger_hook) << " (the one of " << random_time_ms << " ms in the golden run)" << endl;
+        else
+            cout << "Not performed: the occurrence " << trigger_occurrence << " of the hook " << get_trigger_hook_name(trigger_hook) << " has not been reached" << endl;
+        if (injection_tick_valid)
+            cout << "Performed at tick " << injection_tick << endl;
     }
 }
 
 
+// The byte of the fault point is folded on the live part of the task stack, counted down from
+// the top of the stack (where the oldest frames of the task are). The live part is read from the
+// thread data of the task, which is at the top of its FreeRTOS stack.
+void Injection::locate_live_stack_byte(char* tcb) {
+    std::vector<char> thread(get_task_thread_size());
+    void* low = nullptr;
+    void* high = nullptr;
+
+    injected_byte_addr = nullptr;
+    target_byte_number = 0;
+    byte_buffer_before = 0;
+
+    // The task may have been deleted in the meanwhile (and its TCB reused): nothing to inject then
+    if (try_read_memory(get_task_thread_address(tcb), thread.data(), thread.size()))
+        get_task_live_stack(thread.data(), &low, &high);
+
+    // The byte of the fault point counts from the top of the stack (its oldest frames): not live if beyond the sampled depth
+    exploded_size = (size_t)((char*)high - (char*)low);
+    if (fault_point.byte >= exploded_size)
+        return;
+
+    target_byte_number = fault_point.byte;
+    if (!try_read_memory((char*)high - 1 - target_byte_number, &byte_buffer_before, 1)) {
+        exploded_size = 0;
+        target_byte_number = 0;
+        return;
+    }
+    injected_byte_addr = (void*)((char*)high - 1 - target_byte_number);
+}
+
+bool Injection::is_injected() const {
+    return this->injected;
+}
+
+bool Injection::has_injection_tick() const {
+    return this->injection_tick_valid;
+}
+
+unsigned long Injection::get_injection_tick() const {
+    return this->injection_tick;
+}
+
 // Low level read/write memory (platform-dependent)
 #if defined __linux__
-void Injection::read_memory(void* address, char* buffer, size_t size) {
+bool Injection::try_read_memory(void* address, char* buffer, size_t size) {
     struct iovec local[1];
     struct iovec remote[1];
     ssize_t nread;
@@ -166,10 +360,7 @@ void Injection::read_memory(void* address, char* buffer, size_t size) {
     remote[0].iov_len = size;
 
     nread = process_vm_readv(this->linux_pid, local, 1, remote, 1, 0);
-    if (nread == -1) {
-        std::cerr << "Can't read simulator memory" << std::endl;
-        exit(1);
-    }
+    return nread != -1;
 }
 void Injection::write_memory(void* address, char* buffer, size_t size) {
     struct iovec local[1];
@@ -189,16 +380,13 @@ void Injection::write_memory(void* address, char* buffer, size_t size) {
     }
 }
 #elif defined __APPLE__ || defined __MACH__
-void Injection::read_memory(void* address, char* buffer, size_t size) {
+bool Injection::try_read_memory(void* address, char* buffer, size_t size) {
     kern_return_t kret;
     size_t nread;
 
     kret = vm_read_overwrite(this->sim_task_port, (vm_address_t)address, size, (vm_address_t) buffer, &nread);
     //printf("vm_read_overwrite kret: %d, nread: %d\n", kret, nread);
-    if (kret != 0) {
-        std::cerr << "Can't read simulator memory" << std::endl;
-        exit(1);
-    }
+    return kret == 0;
 }
 void Injection::write_memory(void* address, char* buffer, size_t size) {
     kern_return_t kret;
@@ -210,14 +398,11 @@ void Injection::write_memory(void* address, char* buffer, size_t size) {
     }
 }
 #elif defined _WIN32
-void Injection::read_memory(void* address, char* buffer, size_t size) {
+bool Injection::try_read_memory(void* address, char* buffer, size_t size) {
     SIZE_T nread;
 
     ReadProcessMemory(this->sim_proc_handle, address, buffer, size, &nread);
-    if (nread == 0) {
-        std::cerr << "Can't read simulator memory" << std::endl;
-        exit(1);
-    }
+    return nread != 0;
 }
 void Injection::write_memory(void* address, char* buffer, size_t size) {
     SIZE_T nwrite;
@@ -231,6 +416,13 @@ void Injection::write_memory(void* address, char* buffer, size_t size) {
     }
 }
 #endif
+
+void Injection::read_memory(void* address, char* buffer, size_t size) {
+    if (!try_read_memory(address, buffer, size)) {
+        std::cerr << "Can't read simulator memory" << std::endl;
+        exit(1);
+    }
+}
 /*
 #if defined __linux__
     void Injection::inject(std::chrono::steady_clock::time_point begin_time) {
@@ -10,14 +10,22 @@
 
 #include "SimulatorRun.h"
 #include "DataStructure.h"
+#include "FaultSpace.h"
+
+// Master argument: the kernel hook (see trigger.h) at which the faults are injected, instead of after a wall-clock time
+#define TRIGGER_ARG             "--trigger"
 
 class Injection {
 private:
 	SimulatorRun* sr;
-	DataStructure ds;
+	// Owned by the structure table of the run
+	const DataStructure& ds;
     long long pid;
 
-	unsigned long max_time_ms;
+	// Copy of the structure read before the injection
+	char struct_before[STRUCT_BEFORE_SIZE];
+
+	FaultPoint fault_point;
 	unsigned long random_time_ms;
 
 	// Injection structures
@@ -28,6 +36,22 @@ private:
 	unsigned short target_bit_number;
 	size_t exploded_size;
 
+	// The simulator compares its state digests with the golden ones after the injection
+	bool early_stop_armed;
+
+	// Hook occurrence at which the simulator stops for the injection (TRIGGER_HOOK_NONE: after random_time_ms)
+	int trigger_hook;
+	uint64_t trigger_occurrence;
+	std::chrono::steady_clock::duration trigger_timeout;
+	bool trigger_reached;
+
+	// The bit has been flipped
+	bool injected;
+
+	// Kernel tick at which the bit has been flipped (if the simulator exports it)
+	bool injection_tick_valid;
+	unsigned long injection_tick;
+
 #if defined __linux__
 	pid_t linux_pid;
 #elif defined __APPLE__ || defined __MACH__
@@ -37,17 +61,27 @@ private:
 	HANDLE sim_proc_handle;
 #endif
 
+	bool try_read_memory(void* address, char* buffer, size_t size);
 	void read_memory(void* address, char* buffer, size_t size);
 	void write_memory(void* address, char* buffer, size_t size);
+	void locate_live_stack_byte(char* tcb);
 
 public:
-	Injection(SimulatorRun* sr, DataStructure ds, unsigned long max_time_ms);
+	Injection(SimulatorRun* sr, const DataStructure& ds, FaultPoint fault_point);
 	~Injection();
 
 	void init();
+	size_t probe_exploded_size();
+	void arm_early_stop(const std::vector<uint64_t>& golden_digests);
+	bool arm_trigger(int hook, uint64_t occurrence, std::chrono::steady_clock::duration timeout);
+	bool is_trigger_armed() const;
 	void inject(std::chrono::steady_clock::time_point begin_time);
 	void close();
 
+	bool is_injected() const;
+	bool has_injection_tick() const;
+	unsigned long get_injection_tick() const;
+
 	void print_stats(bool use_logger);
 };
 
@@ -0,0 +1,293 @@
+#include "MemorySampler.h"
+
+#include "loguru.hpp"
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+#if defined __linux__
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+#endif
+
+static void put_varint(std::vector<uint8_t>& buf, uint64_t value) {
+    while (value >= 0x80) {
+        buf.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((uint8_t)value);
+}
+
+#if defined __linux__
+static bool read_remote(long long pid, void* addr, void* buf, size_t size) {
+    struct iovec local = { buf, size };
+    struct iovec remote = { addr, size };
+    return process_vm_readv((pid_t)pid, &local, 1, &remote, 1, 0) == (ssize_t)size;
+}
+#endif
+
+MemorySampler::MemorySampler(SimulatorRun& sr, unsigned long period_ms, bool write_samples) {
+    std::string s1 = MEMORY_SAMPLES_FILE_PREFIX;
+    std::string s2 = std::to_string(sr.get_pid());
+    std::string s3 = ".bin";
+
+    this->pid = sr.get_pid();
+    this->path = "output/" + s1 + s2 + s3;
+    this->period = std::chrono::milliseconds(period_ms);
+    this->snapshot_size = 0;
+    this->samples = 0;
+    this->write_samples = write_samples;
+    this->fp = nullptr;
+    this->running = false;
+
+    // Only the structures already allocated when the scheduler starts can be sampled
+    for (auto const& ds : sr.get_data_structures()) {
+        if (ds.get_address() == nullptr)
+            continue;
+        // The stack of a task is reached through its TCB, which is already sampled: only its live size is tracked
+        if (ds.get_type() == TYPE_TASK_STACK) {
+            this->stacks.push_back(ds);
+            continue;
+        }
+        this->data_structures.push_back(ds);
+        this->struct_offsets.push_back(this->snapshot_size);
+        this->snapshot_size += ds.get_fixed_size();
+    }
+
+    this->snapshot.resize(this->snapshot_size);
+    this->previous.assign(this->snapshot_size, 0);
+    this->change_counts.assign(this->snapshot_size, 0);
+    this->max_exploded_sizes.assign(this->data_structures.size(), 0);
+    this->max_live_stacks.assign(this->stacks.size(), 0);
+}
+
+MemorySampler::~MemorySampler() {
+    this->stop();
+}
+
+void MemorySampler::start() {
+#if defined __linux__
+    this->last_sample_time = std::chrono::steady_clock::now();
+    this->running = true;
+
+    if (!this->write_samples) {
+        this->worker = std::thread(&MemorySampler::run, this);
+        return;
+    }
+
+    this->fp = fopen(this->path.c_str(), "wb");
+    if (this->fp == NULL) {
+        std::cerr << "Unable to open " << this->path << " for writing the memory samples." << std::endl;
+        exit(1);
+    }
+
+    // Header
+    uint32_t count = (uint32_t)this->data_structures.size();
+    fwrite(MEMORY_SAMPLES_MAGIC, 1, 8, this->fp);
+    fwrite(&count, sizeof(count), 1, this->fp);
+    for (auto const& ds : this->data_structures) {
+        int32_t id = ds.get_id();
+        uint32_t size = (uint32_t)ds.get_fixed_size();
+        uint64_t address = (uint64_t)(uintptr_t)ds.get_address();
+        std::string name = ds.get_name();
+        uint16_t name_len = (uint16_t)name.size();
+
+        fwrite(&id, sizeof(id), 1, this->fp);
+        fwrite(&size, sizeof(size), 1, this->fp);
+        fwrite(&address, sizeof(address), 1, this->fp);
+        fwrite(&name_len, sizeof(name_len), 1, this->fp);
+        fwrite(name.c_str(), 1, name_len, this->fp);
+    }
+
+    this->worker = std::thread(&MemorySampler::run, this);
+#else
+    // The batched remote read is only available on Linux (process_vm_readv)
+    std::cerr << "The memory sampler is only supported on Linux." << std::endl;
+#endif
+}
+
+void MemorySampler::stop() {
+    this->running = false;
+    if (this->worker.joinable())
+        this->worker.join();
+
+    if (this->fp != nullptr) {
+        fclose(this->fp);
+        this->fp = nullptr;
+    }
+}
+
+void MemorySampler::run() {
+    auto next = std::chrono::steady_clock::now();
+
+    while (this->running) {
+        if (!this->read_snapshot())
+            break;
+        this->update_exploded_sizes();
+        if (this->fp != nullptr) {
+            this->write_record(std::chrono::steady_clock::now());
+        }
+        else {
+            this->previous.swap(this->snapshot);
+            this->samples++;
+        }
+
+        next += this->period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+// Read all the structures with one process_vm_readv call (IOV_MAX structures per call at most).
+// Returns false when the simulator is gone.
+bool MemorySampler::read_snapshot() {
+#if defined __linux__
+    size_t n = this->data_structures.size();
+    std::vector<struct iovec> local(n);
+    std::vector<struct iovec> remote(n);
+
+    for (size_t i = 0; i < n; i++) {
+        local[i].iov_base = this->snapshot.data() + this->struct_offsets[i];
+        local[i].iov_len = this->data_structures[i].get_fixed_size();
+        remote[i].iov_base = this->data_structures[i].get_address();
+        remote[i].iov_len = this->data_structures[i].get_fixed_size();
+    }
+
+    for (size_t i = 0; i < n; i += IOV_MAX) {
+        size_t batch = std::min(n - i, (size_t)IOV_MAX);
+        size_t batch_begin = this->struct_offsets[i];
+        size_t batch_end = (i + batch < n) ? this->struct_offsets[i + batch] : this->snapshot_size;
+
+        ssize_t nread = process_vm_readv((pid_t)this->pid, &local[i], batch, &remote[i], batch, 0);
+        if (nread == -1) {
+            if (errno == ESRCH)
+                return false;
+            nread = 0;
+        }
+
+        // A structure freed in the meanwhile (e.g. a deleted task) truncates the read:
+        // the bytes not read keep their previous value
+        if (batch_begin + (size_t)nread < batch_end)
+            memcpy(this->snapshot.data() + batch_begin + nread, this->previous.data() + batch_begin + nread, batch_end - batch_begin - nread);
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MemorySampler::update_exploded_sizes() {
+    // The exploded size only depends on the fixed part of a structure, which is in the snapshot
+    for (size_t i = 0; i < this->data_structures.size(); i++) {
+        size_t size = this->data_structures[i].get_exploded_size(this->snapshot.data() + this->struct_offsets[i]);
+        this->max_exploded_sizes[i] = std::max(this->max_exploded_sizes[i], size);
+    }
+
+#if defined __linux__
+    // Live stacks, as located by the injection: the TCB, then the thread data of the task
+    std::vector<char> thread(get_task_thread_size());
+    for (size_t i = 0; i < this->stacks.size(); i++) {
+        std::vector<char> tcb(this->stacks[i].get_struct_before_size());
+        void* low = nullptr;
+        void* high = nullptr;
+
+        if (!read_remote(this->pid, this->stacks[i].get_address(), tcb.data(), tcb.size()) ||
+            !read_remote(this->pid, get_task_thread_address(tcb.data()), thread.data(), thread.size()))
+            continue;
+        get_task_live_stack(thread.data(), &low, &high);
+        this->max_live_stacks[i] = std::max(this->max_live_stacks[i], (size_t)((char*)high - (char*)low));
+    }
+#endif
+}
+
+void MemorySampler::write_record(std::chrono::steady_clock::time_point now) {
+    uint64_t delta_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - this->last_sample_time).count();
+    this->last_sample_time = now;
+
+    // Runs of changed bytes w.r.t. the previous sample (the first sample is compared with zeros)
+    std::vector<std::pair<size_t, size_t>> runs;
+    size_t i = 0;
+    while (i < this->snapshot_size) {
+        if (this->snapshot[i] == this->previous[i]) {
+            i++;
+            continue;
+        }
+        size_t begin = i;
+        while (i < this->snapshot_size && this->snapshot[i] != this->previous[i]) {
+            if (this->samples > 0)
+                this->change_counts[i]++;
+            i++;
+        }
+        runs.push_back(std::make_pair(begin, i - begin));
+    }
+
+    this->record.clear();
+    put_varint(this->record, delta_us);
+    put_varint(this->record, runs.size());
+
+    size_t last_end = 0;
+    for (auto const& run : runs) {
+        put_varint(this->record, run.first - last_end);
+        put_varint(this->record, run.second);
+        this->record.insert(this->record.end(), this->snapshot.begin() + run.first, this->snapshot.begin() + run.first + run.second);
+        last_end = run.first + run.second;
+    }
+
+    fwrite(this->record.data(), 1, this->record.size(), this->fp);
+
+    this->previous.swap(this->snapshot);
+    this->samples++;
+}
+
+std::string MemorySampler::get_path() const {
+    return this->path;
+}
+
+unsigned long MemorySampler::get_samples() const {
+    return this->samples;
+}
+
+void MemorySampler::get_max_exploded_sizes(std::map<int, size_t>& sizes) const {
+    for (size_t i = 0; i < this->data_structures.size(); i++) {
+        size_t& size = sizes[this->data_structures[i].get_id()];
+        size = std::max(size, this->max_exploded_sizes[i]);
+    }
+    for (size_t i = 0; i < this->stacks.size(); i++) {
+        size_t& size = sizes[this->stacks[i].get_id()];
+        size = std::max(size, this->max_live_stacks[i]);
+    }
+}
+
+void MemorySampler::print_stats(bool use_logger) {
+    using namespace std;
+
+    if (use_logger) {
+        RAW_LOG_F(INFO, "Memory samples: %lu every %lld us (%s)", this->samples, (long long)this->period.count(), this->path.c_str());
+    }
+    else {
+        cout << "Memory samples: " << this->samples << " every " << this->period.count() << " us (" << this->path << ")" << endl;
+    }
+
+    // How many bytes of each structure are live, and how often the most live one changes
+    for (size_t i = 0; i < this->data_structures.size(); i++) {
+        size_t size = this->data_structures[i].get_fixed_size();
+        auto begin = this->change_counts.begin() + this->struct_offsets[i];
+        auto end = begin + size;
+
+        size_t changed = (size_t)count_if(begin, end, [](uint32_t c) { return c > 0; });
+        if (changed == 0)
+            continue;
+        auto most = max_element(begin, end);
+
+        if (use_logger) {
+            RAW_LOG_F(INFO, "\t%-32s changed bytes: %zu / %zu, most changed: byte %lld (%u changes)", this->data_structures[i].get_name().c_str(),
+                changed, size, (long long)(most - begin), *most);
+        }
+        else {
+            cout << "\t" << left << setw(32) << this->data_structures[i].get_name() << " changed bytes: " << changed << " / " << size
+                << ", most changed: byte " << (most - begin) << " (" << *most << " changes)" << endl;
+        }
+    }
+}
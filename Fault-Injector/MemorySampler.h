@@ -0,0 +1,79 @@
+#ifndef FREERTOS_FAULTINJECTOR_MEMORYSAMPLER_H
+#define FREERTOS_FAULTINJECTOR_MEMORYSAMPLER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SimulatorRun.h"
+#include "DataStructure.h"
+
+// Magic number at the beginning of a samples file (8 bytes, format version included)
+#define MEMORY_SAMPLES_MAGIC    "FISMPL01"
+
+/*
+* Periodically reads the fixed part of all the data structures of a running simulator,
+* with a single batched remote read per sample, and streams the snapshots to a
+* delta-encoded time series file:
+*   header:  magic, structure count, then for each structure: id, size, address, name
+*   records: time since the previous sample (us), number of changed runs, then for each run
+*            the gap from the end of the previous run, its length and the new bytes
+* All the integers of the records are unsigned LEB128 varints and the offsets refer to the
+* concatenation of the structures, in header order.
+* Every sample also updates the largest exploded size seen for each structure (the live stack for
+* the stack of a task), which sizes the fault space; without a file only these sizes are kept.
+*/
+class MemorySampler {
+private:
+    long long pid;
+    std::string path;
+    std::chrono::microseconds period;
+
+    std::vector<DataStructure> data_structures;
+    std::vector<size_t> struct_offsets;
+    size_t snapshot_size;
+
+    std::vector<size_t> max_exploded_sizes;
+    std::vector<DataStructure> stacks;
+    std::vector<size_t> max_live_stacks;
+
+    std::vector<char> snapshot;
+    std::vector<char> previous;
+    std::vector<uint32_t> change_counts;
+    unsigned long samples;
+
+    bool write_samples;
+    FILE* fp;
+    std::vector<uint8_t> record;
+    std::chrono::steady_clock::time_point last_sample_time;
+
+    std::atomic<bool> running;
+    std::thread worker;
+
+    bool read_snapshot();
+    void update_exploded_sizes();
+    void write_record(std::chrono::steady_clock::time_point now);
+    void run();
+
+public:
+    MemorySampler(SimulatorRun& sr, unsigned long period_ms, bool write_samples = true);
+    ~MemorySampler();
+
+    void start();
+    void stop();
+
+    std::string get_path() const;
+    unsigned long get_samples() const;
+
+    // Raise sizes to the largest exploded sizes seen so far
+    void get_max_exploded_sizes(std::map<int, size_t>& sizes) const;
+
+    void print_stats(bool use_logger);
+};
+
+#endif //FREERTOS_FAULTINJECTOR_MEMORYSAMPLER_H
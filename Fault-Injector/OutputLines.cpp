@@ -0,0 +1,91 @@
+#include "OutputLines.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void OutputLines::clear() {
+    this->arena.clear();
+    this->offsets.clear();
+    this->lengths.clear();
+    this->ticks.clear();
+    this->ns.clear();
+}
+
+// Returns false if the file can't be read
+bool OutputLines::load(const std::string& path) {
+    this->clear();
+
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == NULL)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > 0) {
+        this->arena.resize((size_t)size);
+        this->arena.resize(fread(&this->arena[0], 1, (size_t)size, fp));
+    }
+    fclose(fp);
+
+    const char* text = this->arena.c_str();
+    size_t begin = 0;
+    while (begin < this->arena.size()) {
+        const char* newline = (const char*)memchr(text + begin, '\n', this->arena.size() - begin);
+        size_t end = newline != NULL ? (size_t)(newline - text) : this->arena.size();
+
+        // "<tick> <ns>\t<text>" (the numbers are parsed in place: the arena is not split into strings)
+        unsigned long tick = 0;
+        unsigned long long t = 0;
+        size_t offset = begin;
+        const char* tab = (const char*)memchr(text + begin, '\t', end - begin);
+        if (tab != NULL) {
+            char* tick_end;
+            char* ns_end;
+            unsigned long parsed_tick = strtoul(text + begin, &tick_end, 10);
+            unsigned long long parsed_ns = strtoull(tick_end, &ns_end, 10);
+            if (tick_end != text + begin && ns_end != tick_end && ns_end <= tab) {
+                tick = parsed_tick;
+                t = parsed_ns;
+                offset = (size_t)(tab + 1 - text);
+            }
+        }
+
+        this->offsets.push_back(offset);
+        this->lengths.push_back(end - offset);
+        this->ticks.push_back(tick);
+        this->ns.push_back(t);
+        begin = end + 1;
+    }
+
+    return true;
+}
+
+size_t OutputLines::size() const {
+    return this->offsets.size();
+}
+
+bool OutputLines::empty() const {
+    return this->offsets.empty();
+}
+
+std::string_view OutputLines::operator[](size_t i) const {
+    return std::string_view(this->arena.data() + this->offsets[i], this->lengths[i]);
+}
+
+unsigned long OutputLines::get_tick(size_t i) const {
+    return this->ticks[i];
+}
+
+unsigned long long OutputLines::get_ns(size_t i) const {
+    return this->ns[i];
+}
+
+size_t OutputLines::find(std::string_view line, size_t end) const {
+    for (size_t i = 0; i < end; i++) {
+        if ((*this)[i] == line)
+            return i;
+    }
+    return end;
+}
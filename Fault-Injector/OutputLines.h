@@ -0,0 +1,37 @@
+#ifndef FREERTOS_FAULTINJECTOR_OUTPUTLINES_H
+#define FREERTOS_FAULTINJECTOR_OUTPUTLINES_H
+
+#include <stddef.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+* The output of a simulator run, as written by the simulator: one "<tick> <ns>\t<text>" line per print.
+* The file is read at once into a single arena, and every line is a view on its text, with the kernel tick
+* and the monotonic time (ns) at which it was printed. clear() keeps the memory: a reused run does not
+* allocate again for an output which is not larger than the ones it already held.
+*/
+class OutputLines {
+private:
+    std::string arena;
+    std::vector<size_t> offsets;
+    std::vector<size_t> lengths;
+    std::vector<unsigned long> ticks;
+    std::vector<unsigned long long> ns;
+
+public:
+    void clear();
+    bool load(const std::string& path);
+
+    size_t size() const;
+    bool empty() const;
+    std::string_view operator[](size_t i) const;
+    unsigned long get_tick(size_t i) const;
+    unsigned long long get_ns(size_t i) const;
+
+    // The first line before end equal to line (end if there is none)
+    size_t find(std::string_view line, size_t end) const;
+};
+
+#endif //FREERTOS_FAULTINJECTOR_OUTPUTLINES_H
@@ -0,0 +1,58 @@
+#include "PhaseProfile.h"
+
+PhaseProfile::PhaseProfile() {
+    this->reset();
+}
+
+void PhaseProfile::begin(TrialPhase phase) {
+    this->started[phase] = std::chrono::steady_clock::now();
+}
+
+void PhaseProfile::end(TrialPhase phase) {
+    this->durations[phase] += std::chrono::steady_clock::now() - this->started[phase];
+}
+
+void PhaseProfile::reset() {
+    for (int i = 0; i < PHASE_COUNT; i++)
+        this->durations[i] = std::chrono::steady_clock::duration::zero();
+}
+
+void PhaseProfile::add(const PhaseProfile& other) {
+    for (int i = 0; i < PHASE_COUNT; i++)
+        this->durations[i] += other.durations[i];
+}
+
+std::chrono::steady_clock::duration PhaseProfile::get(TrialPhase phase) const {
+    return this->durations[phase];
+}
+
+std::chrono::steady_clock::duration PhaseProfile::total() const {
+    std::chrono::steady_clock::duration sum = std::chrono::steady_clock::duration::zero();
+    for (int i = 0; i < PHASE_COUNT; i++)
+        sum += this->durations[i];
+    return sum;
+}
+
+const char* get_trial_phase_name(int phase) {
+    switch (phase)
+    {
+    case PHASE_SPAWN:
+        return "spawn";
+    case PHASE_HANDSHAKE:
+        return "handshake";
+    case PHASE_READ_DATA_STRUCTURES:
+        return "read_data_structures";
+    case PHASE_WAIT_INJECT:
+        return "wait_inject";
+    case PHASE_READ_WRITE_MEMORY:
+        return "read_write_memory";
+    case PHASE_RUN_TO_COMPLETION:
+        return "run_to_completion";
+    case PHASE_SAVE_OUTPUT:
+        return "save_output";
+    case PHASE_COMPARE:
+        return "compare_with_golden";
+    default:
+        return "invalid";
+    }
+}
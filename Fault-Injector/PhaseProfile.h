@@ -0,0 +1,43 @@
+#ifndef FREERTOS_FAULTINJECTOR_PHASEPROFILE_H
+#define FREERTOS_FAULTINJECTOR_PHASEPROFILE_H
+
+#include <chrono>
+
+/* The phases an injection trial goes through, in execution order */
+enum TrialPhase {
+    PHASE_SPAWN,
+    PHASE_HANDSHAKE,
+    PHASE_READ_DATA_STRUCTURES,
+    PHASE_WAIT_INJECT,
+    PHASE_READ_WRITE_MEMORY,
+    PHASE_RUN_TO_COMPLETION,
+    PHASE_SAVE_OUTPUT,
+    PHASE_COMPARE,
+    PHASE_COUNT
+};
+
+/*
+* Accumulates the wall-clock time spent in each phase of a trial.
+* A phase may be entered more than once (e.g. the two sides of the handshake):
+* the durations are summed.
+*/
+class PhaseProfile {
+private:
+    std::chrono::steady_clock::duration durations[PHASE_COUNT];
+    std::chrono::steady_clock::time_point started[PHASE_COUNT];
+
+public:
+    PhaseProfile();
+
+    void begin(TrialPhase phase);
+    void end(TrialPhase phase);
+    void reset();
+    void add(const PhaseProfile& other);
+
+    std::chrono::steady_clock::duration get(TrialPhase phase) const;
+    std::chrono::steady_clock::duration total() const;
+};
+
+const char* get_trial_phase_name(int phase);
+
+#endif //FREERTOS_FAULTINJECTOR_PHASEPROFILE_H
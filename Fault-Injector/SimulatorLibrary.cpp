@@ -0,0 +1,81 @@
+#include "SimulatorLibrary.h"
+
+#include <iostream>
+#include <vector>
+
+
+#if defined SIMULATOR_LIBRARY && defined __linux__
+#include <dlfcn.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+SimulatorLibrary simulator_library;
+
+SimulatorLibrary::SimulatorLibrary() {
+    this->handle = nullptr;
+    this->entry = nullptr;
+}
+
+bool SimulatorLibrary::load(const std::string& path) {
+#if defined SIMULATOR_LIBRARY && defined __linux__
+    if (this->handle != nullptr)
+        return true;
+
+    this->handle = dlmopen(LM_ID_NEWLM, path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (this->handle == nullptr)
+        return false;
+
+    this->entry = (int (*)(int, char**))dlsym(this->handle, SIMULATOR_LIBRARY_ENTRY);
+    if (this->entry == nullptr) {
+        dlclose(this->handle);
+        this->handle = nullptr;
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SimulatorLibrary::is_loaded() const {
+    return this->entry != nullptr;
+}
+
+pid_t SimulatorLibrary::spawn(const std::vector<std::string>& args, const std::function<void()>& child_setup) {
+#if defined SIMULATOR_LIBRARY && defined __linux__
+    pid_t pid = fork();
+
+    if (pid == -1) {
+        std::cerr << "Unable to fork a simulator run." << std::endl;
+        exit(1);
+    }
+
+    if (pid == 0) {
+        // The simulator sets up its own signals: drop the handlers and the mask of the injector
+        sigset_t all_signals;
+        for (int sig = 1; sig < NSIG; sig++)
+            signal(sig, SIG_DFL);
+        sigemptyset(&all_signals);
+        sigprocmask(SIG_SETMASK, &all_signals, NULL);
+        child_setup();
+
+        std::string name = "FreeRTOS_Simulator";
+        std::vector<char*> argv;
+        argv.push_back(&name[0]);
+        for (auto const& arg : args)
+            argv.push_back((char*)arg.c_str());
+        argv.push_back(nullptr);
+
+        // The simulator exits by itself (through the libc of its namespace) at the end of the run
+        _exit(this->entry((int)argv.size() - 1, argv.data()));
+    }
+
+    return pid;
+#else
+    (void)args;
+    (void)child_setup;
+    return -1;
+#endif
+}
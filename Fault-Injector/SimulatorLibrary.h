@@ -0,0 +1,47 @@
+#ifndef FREERTOS_FAULTINJECTOR_SIMULATORLIBRARY_H
+#define FREERTOS_FAULTINJECTOR_SIMULATORLIBRARY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "simulator_config.h"
+
+// Shared library build of the simulator (SIMULATOR_LIBRARY) and its entry point
+#define SIMULATOR_LIBRARY_PATH      "./libFreeRTOS_Simulator.so"
+#define SIMULATOR_LIBRARY_ENTRY     "simulator_main"
+
+/*
+* The simulator built as a shared library, loaded once in a new link-map namespace
+* (dlmopen with LM_ID_NEWLM): the kernel, the libc and all the globals of the library
+* are separate from the ones of the injector (which links the kernel sources too) and
+* are never run by the injector.
+* Each simulator run is a fork of the injector that calls the entry point of the library,
+* so it starts from the pristine globals without an exec and a dynamic loading per run,
+* and a crash only kills the forked process.
+*
+* Only one kernel can run in a process: the Posix port drives the tick with the
+* process-wide ITIMER_REAL/SIGALRM and resumes the tasks with SIGUSR1.
+*/
+class SimulatorLibrary {
+private:
+    void* handle;
+    int (*entry)(int, char**);
+
+public:
+    SimulatorLibrary();
+
+    // Returns false if the library is not available: the simulator executable is used instead
+    bool load(const std::string& path);
+    bool is_loaded() const;
+
+    // Fork a simulator run with the given arguments (e.g. the workload manifest).
+    // child_setup is called in the forked process before entering the simulator.
+    pid_t spawn(const std::vector<std::string>& args, const std::function<void()>& child_setup);
+};
+
+// Library shared by all the simulator runs of the process
+extern SimulatorLibrary simulator_library;
+
+#endif //FREERTOS_FAULTINJECTOR_SIMULATORLIBRARY_H
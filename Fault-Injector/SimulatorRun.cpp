@@ -6,27 +6,195 @@
 
 #include "loguru.hpp"
 #include <sstream>
+#include <iomanip>
+
+#if defined __linux__
+#include <sys/personality.h>
+#include <sys/uio.h>
+#endif
+#if !defined _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <climits>
+
+#if !defined _WIN32
+// In the simulator process: only the simulator ends of the handshake pipes are kept (across the exec too)
+static void setup_simulator_sync(const int injector_fds[2], const int simulator_fds[2]) {
+    close(injector_fds[0]);
+    close(injector_fds[1]);
+    fcntl(simulator_fds[0], F_SETFD, 0);
+    fcntl(simulator_fds[1], F_SETFD, 0);
+}
+
+// The pipes are not inherited by the other processes spawned by the injector
+static bool open_sync_pipe(int fds[2]) {
+    if (pipe(fds) == -1)
+        return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+#else
+// The semaphores of the handshake with a simulator process, named after its PID
+static void remove_log_struct_semaphores(bp::pid_t child_pid) {
+    std::string pid = std::to_string(child_pid);
+    std::string sem1_name = "binary_sem_log_struct_" + pid + "_1";
+    std::string sem2_name = "binary_sem_log_struct_" + pid + "_2";
+
+    boost::interprocess::shared_memory_object::remove(sem1_name.c_str());
+    boost::interprocess::shared_memory_object::remove(sem2_name.c_str());
+}
+#endif
+
+// Set up the simulator process before the exec
+struct simulator_exec_setup : bp::extend::handler {
+    int injector_fds[2];
+    int simulator_fds[2];
+
+    template<typename Executor>
+    void on_exec_setup(Executor&) const {
+#if defined __linux__
+        // Run the simulator without address space randomization: all the runs have the address map of the golden run
+        personality(personality(0xffffffff) | ADDR_NO_RANDOMIZE);
+#endif
+#if !defined _WIN32
+        setup_simulator_sync(this->injector_fds, this->simulator_fds);
+#endif
+    }
+};
+
+// The table of a run whose data structures have not been read yet
+static const std::shared_ptr<const DataStructureTable> no_structures = std::make_shared<DataStructureTable>();
 
 SimulatorRun::SimulatorRun() {
-    this->loaded_duration = nullptr;
+    this->structures = no_structures;
+    this->duration_loaded = false;
     this->error_matched_str = "";
     this->delayed_str = "";
     this->delay_amount = 0;
+    this->delay_ticks = 0;
+    this->injection_tick = 0;
+    this->first_divergence_line = -1;
+    this->first_divergence_tick = 0;
+    this->max_line_delay_ticks = 0;
+    this->total_run_time_us = 0;
+    this->sync_read_fd = -1;
+    this->sync_write_fd = -1;
+    this->done_received = false;
+    this->done_payload = 0;
+    this->stopped_at_trigger = false;
+    this->progress_cycles = 0;
+    this->timing_violation_lateness = 0;
+    this->timing_violation_bound = 0;
 }
 
 SimulatorRun::~SimulatorRun() {
-    std::string pid = std::to_string(this->c.id());
-    std::string sem1_name = "binary_sem_log_struct_" + pid + "_1";
-    std::string sem2_name = "binary_sem_log_struct_" + pid + "_2";
+#if defined _WIN32
+    remove_log_struct_semaphores(this->c.id());
+#else
+    if (this->sync_read_fd != -1)
+        close(this->sync_read_fd);
+    if (this->sync_write_fd != -1)
+        close(this->sync_write_fd);
+#endif
+}
 
-    boost::interprocess::shared_memory_object::remove(sem1_name.c_str());
-    boost::interprocess::shared_memory_object::remove(sem2_name.c_str());
+// Back to the state of a new run, keeping the memory of the previous one
+void SimulatorRun::reset() {
+#if defined _WIN32
+    // The next simulator process has other semaphores
+    if (this->c.id() != 0)
+        remove_log_struct_semaphores(this->c.id());
+#else
+    if (this->sync_read_fd != -1)
+        close(this->sync_read_fd);
+    if (this->sync_write_fd != -1)
+        close(this->sync_write_fd);
+#endif
+    this->sync_read_fd = -1;
+    this->sync_write_fd = -1;
+    this->done_received = false;
+    this->done_payload = 0;
+    this->stopped_at_trigger = false;
+    this->progress_cycles = 0;
+
+    this->output.clear();
+    this->duration_loaded = false;
+    this->error_matched_str.clear();
+    this->delayed_str.clear();
+    this->delay_amount = 0;
+    this->delay_ticks = 0;
+    this->injection_tick = 0;
+    this->first_divergence_line = -1;
+    this->first_divergence_tick = 0;
+    this->max_line_delay_ticks = 0;
+    this->deadline_stats.clear();
+    this->timing_violation_key.clear();
+    this->timing_violation_lateness = 0;
+    this->timing_violation_bound = 0;
+    this->task_stats.clear();
+    this->total_run_time_us = 0;
+    this->state_digests.clear();
+    this->trigger_counts.clear();
+    this->profile.reset();
 }
 
-void SimulatorRun::init(std::string sim_path) {
-    bp::child new_child(sim_path);
-    this->c = std::move(new_child);
+void SimulatorRun::init(std::string sim_path, std::string workload, const SimulatorRun* layout) {
+    this->reset();
+    this->workload = workload;
+
+    this->profile.begin(PHASE_SPAWN);
+    simulator_exec_setup setup;
+    std::vector<std::string> args;
+    if (workload != "") {
+        args.push_back(WORKLOAD_ARG);
+        args.push_back(workload);
+    }
+#if !defined _WIN32
+    // Handshake pipes: simulator -> injector and injector -> simulator
+    int to_injector[2];
+    int to_simulator[2];
+    if (!open_sync_pipe(to_injector) || !open_sync_pipe(to_simulator)) {
+        std::cerr << "Unable to create the handshake pipes of the simulator." << std::endl;
+        exit(1);
+    }
+    setup.injector_fds[0] = to_injector[0];
+    setup.injector_fds[1] = to_simulator[1];
+    setup.simulator_fds[0] = to_simulator[0];
+    setup.simulator_fds[1] = to_injector[1];
+    args.push_back(SYNC_FDS_ARG);
+    args.push_back(std::to_string(setup.simulator_fds[0]) + "," + std::to_string(setup.simulator_fds[1]));
+#endif
+
+    if (simulator_library.is_loaded()) {
+        // A fork inherits the address map of the injector, so the runs already share it
+        pid_t pid = simulator_library.spawn(args, [&setup]() {
+#if !defined _WIN32
+            setup_simulator_sync(setup.injector_fds, setup.simulator_fds);
+#endif
+        });
+        bp::child new_child(pid);
+        this->c = std::move(new_child);
+    }
+    else {
+        bp::child new_child(sim_path, bp::args(args), setup);
+        this->c = std::move(new_child);
+    }
+
+#if !defined _WIN32
+    close(setup.simulator_fds[0]);
+    close(setup.simulator_fds[1]);
+    this->sync_read_fd = setup.injector_fds[0];
+    this->sync_write_fd = setup.injector_fds[1];
+#endif
+    this->profile.end(PHASE_SPAWN);
 
+    this->profile.begin(PHASE_HANDSHAKE);
+#if defined _WIN32
     std::string pid = std::to_string(this->c.id());
     std::string sem1_name = "binary_sem_log_struct_" + pid + "_1";
 
@@ -34,12 +202,61 @@ void SimulatorRun::init(std::string sim_path) {
 
     // Wait that the data structures are ready to be read
     s1.wait();
+#else
+    // Wait that the data structures are ready to be read
+    SyncMessage ready;
+    if (!this->sync_receive(ready) || ready.event != SYNC_EVENT_READY) {
+        std::cerr << "The simulator (PID " << this->c.id() << ") exited before logging its data structures." << std::endl;
+        exit(1);
+    }
+#endif
+    this->profile.end(PHASE_HANDSHAKE);
 
     // Read data structures
-    this->read_data_structures();
+    this->profile.begin(PHASE_READ_DATA_STRUCTURES);
+    if (layout != nullptr && this->same_heap_arena(*layout)) {
+        this->structures = layout->structures;
+    }
+    else {
+        if (layout != nullptr)
+            LOG_F(WARNING, "The heap arena of the simulator (PID %d) is not where it is in the golden run: its data structures are read", (int)this->c.id());
+        this->read_data_structures();
+    }
+    this->profile.end(PHASE_READ_DATA_STRUCTURES);
+}
+
+// The arena is mapped at another address when its fixed one is taken (see heap_arena_init), and so are the kernel objects in it
+bool SimulatorRun::same_heap_arena(const SimulatorRun& layout) const {
+    void* symbol = layout.get_symbol(HEAP_ARENA_SYM_BASE);
+    void* base = nullptr;
+
+    // No arena: the kernel objects are allocated statically
+    if (symbol == nullptr)
+        return true;
+
+#if defined __linux__
+    struct iovec local[1];
+    struct iovec remote[1];
+    local[0].iov_base = &base;
+    local[0].iov_len = sizeof(base);
+    remote[0].iov_base = symbol;
+    remote[0].iov_len = sizeof(base);
+    if (process_vm_readv((pid_t)this->c.id(), local, 1, remote, 1, 0) != (ssize_t)sizeof(base))
+        return false;
+#else
+    return true;
+#endif
+
+    for (auto const& ds : layout.get_data_structures()) {
+        if (ds.get_type() == TYPE_HEAP_ARENA)
+            return ds.get_address() == base;
+    }
+    return false;
 }
 
-void SimulatorRun::start() {
+void SimulatorRun::start(bool hold_handshake) {
+    this->profile.begin(PHASE_HANDSHAKE);
+#if defined _WIN32
     std::string pid = std::to_string(this->c.id());
     std::string sem2_name = "binary_sem_log_struct_" + pid + "_2";
 
@@ -47,10 +264,56 @@ void SimulatorRun::start() {
     
     // Signal to the simulator that it can start
     s2.post();
+#else
+    // Signal to the simulator that it can start
+    SyncMessage msg = { SYNC_EVENT_START, 0, 0 };
+    while (write(this->sync_write_fd, &msg, sizeof(msg)) == -1 && errno == EINTR);
+    if (!hold_handshake) {
+        close(this->sync_write_fd);
+        this->sync_write_fd = -1;
+    }
+#endif
+    this->profile.end(PHASE_HANDSHAKE);
 
     this->begin_time = std::chrono::steady_clock::now();
 }
 
+// Reads the messages of the simulator until it reaches the armed trigger: it is then stopped at the hook until resume().
+// False if the simulator exits or the deadline passes first (it is resumed anyway, should it reach the trigger later).
+bool SimulatorRun::wait_trigger(std::chrono::steady_clock::time_point deadline) {
+#if defined _WIN32
+    return false;
+#else
+    SyncMessage msg;
+    bool timed_out;
+
+    while (this->sync_poll(deadline, msg, timed_out)) {
+        if (msg.event == SYNC_EVENT_TRIGGER) {
+            this->stopped_at_trigger = true;
+            return true;
+        }
+        this->record_message(msg);
+    }
+    return false;
+#endif
+}
+
+void SimulatorRun::resume() {
+#if !defined _WIN32
+    if (this->sync_write_fd == -1)
+        return;
+
+    // A simulator not stopped at the trigger (e.g. it has exited) reads the end of the pipe instead, if it ever gets there
+    if (this->stopped_at_trigger) {
+        SyncMessage msg = { SYNC_EVENT_RESUME, 0, 0 };
+        while (write(this->sync_write_fd, &msg, sizeof(msg)) == -1 && errno == EINTR);
+        this->stopped_at_trigger = false;
+    }
+    close(this->sync_write_fd);
+    this->sync_write_fd = -1;
+#endif
+}
+
 void SimulatorRun::read_data_structures() {
     std::string s1 = MEM_LOG_FILE_PREFIX;
     std::string s2 = std::to_string(this->c.id());
@@ -67,21 +330,31 @@ void SimulatorRun::read_data_structures() {
     char struct_name[100];
     int struct_type;
     void *struct_address;
+    std::shared_ptr<DataStructureTable> table = std::make_shared<DataStructureTable>();
 
     char buffer[100];
     int n_read;
 
     fgets(buffer, 100, structures_log_fp);
     //std::cout << buffer;
-    while (fscanf(structures_log_fp, "%d %s %d %p\n", &struct_id, struct_name, &struct_type, &struct_address) == 4) {
+    while (fgets(buffer, 100, structures_log_fp) != NULL) {
+        // Symbols (kernel variables read by the injector) start with '#'
+        if (buffer[0] == '#') {
+            if (sscanf(buffer, "# %s %p", struct_name, &struct_address) == 2)
+                table->add_symbol(struct_name, struct_address);
+            continue;
+        }
+        if (sscanf(buffer, "%d %s %d %p", &struct_id, struct_name, &struct_type, &struct_address) != 4)
+            break;
         // printf("Id: %d, Name: %s, Type: %d, Address: %p\n", struct_id, struct_name, struct_type, struct_address);
         DataStructure ds(struct_id, struct_name, struct_type, struct_address);
-        this->data_structures.push_back(ds);
+        table->add(ds);
     }
+    this->structures = table;
 
     // Debug
     /*
-    for (auto const& ds : this->data_structures) {
+    for (auto const& ds : this->structures->get_structures()) {
         std::cout << ds << std::endl;
     }
     */
@@ -89,8 +362,87 @@ void SimulatorRun::read_data_structures() {
     fclose(structures_log_fp);
 }
 
+// Blocks until a message of the simulator arrives: false if the simulator closed its end (e.g. it exited)
+bool SimulatorRun::sync_receive(SyncMessage& msg) {
+#if defined _WIN32
+    return false;
+#else
+    ssize_t n;
+
+    do {
+        n = read(this->sync_read_fd, &msg, sizeof(msg));
+    } while (n == -1 && errno == EINTR);
+
+    return n == (ssize_t)sizeof(msg);
+#endif
+}
+
+// Waits for the next message of the simulator: false if the simulator closed its end (it is exiting)
+// or, with timed_out set, if the deadline passes first
+bool SimulatorRun::sync_poll(std::chrono::steady_clock::time_point deadline, SyncMessage& msg, bool& timed_out) {
+#if defined _WIN32
+    timed_out = false;
+    return false;
+#else
+    timed_out = false;
+    while (true) {
+        int timeout_ms = -1;
+        if (deadline != std::chrono::steady_clock::time_point::max()) {
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero()) {
+                timed_out = true;
+                return false;
+            }
+            timeout_ms = (int)std::min<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(left).count() + 1, INT_MAX);
+        }
+
+        struct pollfd pfd = { this->sync_read_fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready == -1 && errno == EINTR)
+            continue;
+        if (ready == 0)
+            continue;
+        return ready != -1 && this->sync_receive(msg);
+    }
+#endif
+}
+
+// Keeps the outcome of a done message and the cycles of a progress report: true if the report is a new cycle
+bool SimulatorRun::record_message(const SyncMessage& msg) {
+    if (msg.event == SYNC_EVENT_DONE) {
+        this->done_received = true;
+        this->done_payload = msg.payload;
+    }
+    else if (msg.event == SYNC_EVENT_PROGRESS && msg.payload > this->progress_cycles) {
+        this->progress_cycles = (unsigned long)msg.payload;
+        this->progress_time = std::chrono::steady_clock::now();
+        return true;
+    }
+    return false;
+}
+
+// Reads the messages of the running simulator until it closes its end (it is exiting): false if the deadline passes first.
+// If extend is set, every progress report moves the deadline one check cycle (at the pace of this run, plus the margin)
+// after the report, but not after limit.
+bool SimulatorRun::receive_until(std::chrono::steady_clock::time_point deadline, bool extend, std::chrono::steady_clock::time_point limit) {
+    SyncMessage msg;
+    bool timed_out;
+
+    while (this->sync_poll(deadline, msg, timed_out)) {
+        if (this->record_message(msg) && extend) {
+            std::chrono::steady_clock::duration cycle = (this->progress_time - this->begin_time) / (long long)this->progress_cycles;
+            std::chrono::steady_clock::time_point next = this->progress_time + cycle * (100 + HANG_TIMEOUT_MARGIN_PERCENT) / 100;
+            deadline = std::max(deadline, std::min(next, limit));
+        }
+    }
+    return !timed_out;
+}
+
 std::error_code SimulatorRun::wait() {
     std::error_code error;
+    // The pipe is drained until the simulator exits, so that its progress reports never block it
+    if (this->sync_read_fd != -1)
+        this->receive_until(std::chrono::steady_clock::time_point::max(), false, std::chrono::steady_clock::time_point::max());
     this->c.wait(error);
     this->end_time = std::chrono::steady_clock::now();
 
@@ -98,22 +450,55 @@ std::error_code SimulatorRun::wait() {
 }
 
 bool SimulatorRun::wait_for(const std::chrono::steady_clock::duration& rel_time, std::error_code& ec) {
-    bool time_has_not_expired = this->c.wait_for(rel_time, ec);
+    this->profile.begin(PHASE_RUN_TO_COMPLETION);
+    bool time_has_not_expired;
+    if (this->sync_read_fd != -1) {
+        auto deadline = std::chrono::steady_clock::now() + rel_time;
+        time_has_not_expired = this->receive_until(deadline, false, deadline);
+        if (time_has_not_expired)
+            this->c.wait(ec);
+    }
+    else {
+        time_has_not_expired = this->c.wait_for(rel_time, ec);
+    }
     this->end_time = std::chrono::steady_clock::now();
+    this->profile.end(PHASE_RUN_TO_COMPLETION);
+
+    return time_has_not_expired;
+}
+
+// Waits for the run until timeout (from its start), extended while the simulator reports progress
+// (see HANG_TIMEOUT_MAX_FACTOR). Without the handshake pipe the timeout is not extended.
+bool SimulatorRun::wait_progressing(const std::chrono::steady_clock::duration& timeout, std::error_code& ec) {
+    auto deadline = this->begin_time + timeout;
+
+    if (this->sync_read_fd == -1)
+        return this->wait_for(std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero()), ec);
+
+    this->profile.begin(PHASE_RUN_TO_COMPLETION);
+    bool time_has_not_expired = this->receive_until(deadline, true, this->begin_time + timeout * HANG_TIMEOUT_MAX_FACTOR);
+    if (time_has_not_expired)
+        this->c.wait(ec);
+    this->end_time = std::chrono::steady_clock::now();
+    this->profile.end(PHASE_RUN_TO_COMPLETION);
 
     return time_has_not_expired;
 }
 
 std::chrono::steady_clock::duration SimulatorRun::duration() {
-    if (this->loaded_duration != nullptr)
-        return *(this->loaded_duration);
+    if (this->duration_loaded)
+        return this->loaded_duration;
 
     return (this->end_time - this->begin_time);
 }
 
 void SimulatorRun::load_duration(unsigned long ms) {
-    auto dur = std::chrono::milliseconds(ms);
-    this->loaded_duration = new std::chrono::steady_clock::duration(dur);
+    this->loaded_duration = std::chrono::milliseconds(ms);
+    this->duration_loaded = true;
+}
+
+void SimulatorRun::load_workload(const std::string& workload) {
+    this->workload = workload;
 }
 
 void SimulatorRun::terminate() {
@@ -121,30 +506,157 @@ void SimulatorRun::terminate() {
 }
 
 void SimulatorRun::save_output(int* pid) {
-    std::ifstream output_file;
     std::string pid_str = pid != nullptr ? std::to_string(*pid) : std::to_string(this->c.id());
     std::string output_f_pref = OUTPUT_FILE_PREFIX;
     std::string path = "output/" + output_f_pref + pid_str + ".txt";
-    std::string line;
 
-    output_file.open(path);
-    if (output_file.is_open()) {
-        while (std::getline(output_file, line))
-            this->output.push_back(line);
-    }
-    else {
+    this->profile.begin(PHASE_SAVE_OUTPUT);
+    if (!this->output.load(path))
         std::cout << "Unable to open " << path << std::endl;
-    }
 
-    output_file.close();
+    this->read_task_stats(pid_str);
+    this->read_deadline_stats(pid_str);
+    this->read_state_digests(pid_str);
+    this->read_trigger_counts(pid_str);
+    this->profile.end(PHASE_SAVE_OUTPUT);
 
     // Debug
     /*
-    for (auto const& s : this->output)
-        std::cout << s << std::endl;
+    for (size_t i = 0; i < this->output.size(); i++)
+        std::cout << this->output[i] << std::endl;
     */
 }       
 
+void SimulatorRun::read_task_stats(const std::string& pid_str) {
+    std::ifstream stats_file;
+    std::string stats_f_pref = TASK_STATS_FILE_PREFIX;
+    std::string path = "output/" + stats_f_pref + pid_str + ".txt";
+    std::string line;
+
+    this->task_stats.clear();
+    this->total_run_time_us = 0;
+
+    stats_file.open(path);
+    if (!stats_file.is_open()) {
+        std::cout << "Unable to open " << path << std::endl;
+        return;
+    }
+
+    // Header, then the total run time, then one line per task
+    std::getline(stats_file, line);
+    stats_file >> this->total_run_time_us;
+    while (std::getline(stats_file, line)) {
+        std::istringstream ss(line);
+        TaskStats ts;
+
+        if (!(ss >> ts.number >> ts.run_time_us >> ts.switches >> ts.stack_high_water_mark))
+            continue;
+        // The name is the rest of the line and may contain spaces
+        std::getline(ss >> std::ws, ts.name);
+        this->task_stats.push_back(ts);
+    }
+
+    stats_file.close();
+}
+
+void SimulatorRun::read_deadline_stats(const std::string& pid_str) {
+    std::ifstream stats_file;
+    std::string stats_f_pref = DEADLINE_STATS_FILE_PREFIX;
+    std::string path = "output/" + stats_f_pref + pid_str + ".txt";
+    std::string line;
+
+    this->deadline_stats.clear();
+
+    stats_file.open(path);
+    if (!stats_file.is_open()) {
+        std::cout << "Unable to open " << path << std::endl;
+        return;
+    }
+
+    // Header, then one line per task or timer
+    std::getline(stats_file, line);
+    while (std::getline(stats_file, line)) {
+        std::istringstream ss(line);
+        std::string kind, name;
+        unsigned long period;
+        DeadlineStats ds;
+
+        if (!(ss >> kind >> period >> ds.activations >> ds.misses >> ds.worst_lateness))
+            continue;
+        // The name is the rest of the line and may contain spaces
+        std::getline(ss >> std::ws, name);
+
+        // Tasks and timers with the same name and period (e.g. the instances of a demo) are merged
+        std::string key = kind + " " + name + " (" + std::to_string(period) + ")";
+        auto it = this->deadline_stats.find(key);
+        if (it == this->deadline_stats.end()) {
+            this->deadline_stats[key] = ds;
+        }
+        else {
+            it->second.activations += ds.activations;
+            it->second.misses += ds.misses;
+            it->second.worst_lateness = std::max(it->second.worst_lateness, ds.worst_lateness);
+        }
+    }
+
+    stats_file.close();
+}
+
+void SimulatorRun::read_state_digests(const std::string& pid_str) {
+#if defined STATE_DIGEST
+    std::ifstream digests_file;
+    std::string digests_f_pref = STATE_DIGEST_FILE_PREFIX;
+    std::string path = "output/" + digests_f_pref + pid_str + ".txt";
+    std::string line;
+
+    this->state_digests.clear();
+
+    digests_file.open(path);
+    if (!digests_file.is_open()) {
+        std::cout << "Unable to open " << path << std::endl;
+        return;
+    }
+
+    while (std::getline(digests_file, line)) {
+        if (line != "")
+            this->state_digests.push_back(std::stoull(line, nullptr, 16));
+    }
+
+    digests_file.close();
+#endif
+}
+
+void SimulatorRun::read_trigger_counts(const std::string& pid_str) {
+    std::ifstream counts_file;
+    std::string counts_f_pref = TRIGGER_COUNTS_FILE_PREFIX;
+    std::string path = "output/" + counts_f_pref + pid_str + ".txt";
+    std::string line;
+
+    this->trigger_counts.assign(TRIGGER_HOOK_COUNT, 0);
+
+    counts_file.open(path);
+    if (!counts_file.is_open()) {
+        std::cout << "Unable to open " << path << std::endl;
+        return;
+    }
+
+    // Header, then one line per hook
+    std::getline(counts_file, line);
+    while (std::getline(counts_file, line)) {
+        std::istringstream ss(line);
+        std::string name;
+        uint64_t count;
+
+        if (!(ss >> name >> count))
+            continue;
+        int hook = get_trigger_hook(name.c_str());
+        if (hook != TRIGGER_HOOK_NONE)
+            this->trigger_counts[hook] = count;
+    }
+
+    counts_file.close();
+}
+
 void SimulatorRun::show_output() {
     std::ifstream output_file;
     std::string path = OUTPUT_FILE_PREFIX + std::to_string(this->c.id()) + ".txt";
@@ -169,6 +681,8 @@ void SimulatorRun::print_stats(bool use_logger) {
 
     ss << "Simulator run (PID " << this->get_pid() << ") stats:\n";
     ss << "Native exit code: " << this->get_native_exit_code() << std::endl;
+    if (this->done_received)
+        ss << "Run reported done with exit code " << this->done_payload << std::endl;
     ss << "Execution took " << std::chrono::duration_cast<std::chrono::seconds>(this->duration()).count() << " seconds." << std::endl;
 
     if (use_logger) {
@@ -179,50 +693,155 @@ void SimulatorRun::print_stats(bool use_logger) {
     }
 }
 
+void SimulatorRun::print_task_stats(const SimulatorRun* golden, bool use_logger) {
+    using namespace std;
+
+    stringstream ss;
+
+    if (this->task_stats.empty())
+        return;
+
+    ss << "Task stats (PID " << this->get_pid() << "), total run time " << this->total_run_time_us << " us";
+    if (golden != nullptr)
+        ss << " (" << showpos << (long long)this->total_run_time_us - (long long)golden->total_run_time_us << noshowpos << " us w.r.t. golden)";
+    ss << ":\n";
+    ss << left << setw(14) << "Task" << right << setw(14) << "CPU (us)" << setw(12) << "Switches" << setw(12) << "Stack HWM";
+    if (golden != nullptr)
+        ss << setw(14) << "CPU delta" << setw(12) << "Sw. delta";
+    ss << "\n";
+
+    // Tasks are matched with the golden ones by name, in order of creation
+    vector<bool> matched(golden != nullptr ? golden->task_stats.size() : 0, false);
+    for (auto const& ts : this->task_stats) {
+        ss << left << setw(14) << ts.name << right << setw(14) << ts.run_time_us << setw(12) << ts.switches << setw(12) << ts.stack_high_water_mark;
+        if (golden != nullptr) {
+            size_t j;
+            for (j = 0; j < golden->task_stats.size(); j++) {
+                if (!matched[j] && golden->task_stats[j].name == ts.name)
+                    break;
+            }
+            if (j < golden->task_stats.size()) {
+                matched[j] = true;
+                ss << showpos << setw(14) << (long long)ts.run_time_us - (long long)golden->task_stats[j].run_time_us
+                    << setw(12) << (long long)ts.switches - (long long)golden->task_stats[j].switches << noshowpos;
+            }
+            else {
+                ss << setw(14) << "new" << setw(12) << "new";
+            }
+        }
+        ss << "\n";
+    }
+
+    if (use_logger) {
+        RAW_LOG_F(INFO, "%s", ss.str().c_str());
+    }
+    else {
+        cout << ss.str() << endl;
+    }
+}
+
+void SimulatorRun::set_injection_tick(unsigned long tick) {
+    this->injection_tick = tick;
+}
+
+void SimulatorRun::find_first_divergence(const SimulatorRun& golden, size_t golden_size) {
+    size_t n = std::min(this->output.size(), golden_size);
+
+    this->first_divergence_line = -1;
+    this->max_line_delay_ticks = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (this->output[i] != golden.output[i]) {
+            // Lines printed before the injection differ because of the simulator non-determinism
+            if (this->output.get_tick(i) < this->injection_tick)
+                continue;
+            this->first_divergence_line = i;
+            break;
+        }
+        // Same line, printed later (or earlier) than in the golden run
+        long long d = (long long)this->output.get_tick(i) - (long long)golden.output.get_tick(i);
+        if (d > this->max_line_delay_ticks)
+            this->max_line_delay_ticks = d;
+    }
+
+    // One output is the prefix of the other: the divergence is where the shorter one ends
+    if (this->first_divergence_line == -1 && this->output.size() != golden_size)
+        this->first_divergence_line = n;
+
+    if (this->first_divergence_line != -1 && !this->output.empty()) {
+        size_t line = std::min((size_t)this->first_divergence_line, this->output.size() - 1);
+        this->first_divergence_tick = this->output.get_tick(line);
+    }
+}
+
 SimulatorError SimulatorRun::compare_with_golden(const SimulatorRun& golden, std::string error_pattern) {
     // Output out-of-order -> Delay
     // Output different -> SDC
     // Output equal -> Masked
 
-    if (this->output.size() != golden.output.size())
+    // Lines reordered or changed as in the reference runs of the golden one are not a failure
+    const ToleranceModel& tolerance = golden.tolerance;
+
+    // A run stopped early by the state digest is compared with the same amount of golden output
+    size_t golden_size = golden.output.size();
+    if (this->stopped_early())
+        golden_size = std::min(golden_size, this->output.size());
+
+    this->find_first_divergence(golden, golden_size);
+
+    if (this->output.size() != golden_size && !(golden_size == golden.output.size() && tolerance.output_size_seen(this->output.size())))
         return SDC;
 
+    // A line of the error pattern is a failure even if the reference runs printed it too
+    std::string upper_pattern = error_pattern;
+    std::for_each(upper_pattern.begin(), upper_pattern.end(), [](char& c) {
+        c = ::toupper(c);
+        });
+    auto is_error_line = [&upper_pattern](std::string_view line) {
+        std::string upper_line(line);
+        std::for_each(upper_line.begin(), upper_line.end(), [](char& c) {
+            c = ::toupper(c);
+            });
+        return upper_pattern != "" && upper_line.find(upper_pattern) != std::string::npos;
+    };
+
     bool masked = true;
     bool sdc = false;
     for (int i = 0; i < this->output.size(); i++) {
-        if (this->output[i] == golden.output[i])
+        if (i < golden_size && this->output[i] == golden.output[i])
             continue;
+        if (!is_error_line(this->output[i])) {
+            if (tolerance.may_vary(this->output[i]))
+                continue;
+            if (tolerance.may_reorder(this->output[i]) && golden.output.find(this->output[i], golden_size) != golden_size)
+                continue;
+        }
         masked = false;
         bool out_of_order = false;
         if (sdc == false) {
-            for (int j = 0; j < golden.output.size(); j++) {
+            for (int j = 0; j < golden_size; j++) {
                 if (this->output[i] == golden.output[j]) {
-                    if (j < i)
+                    if (j < i) {
+                        long long d = (long long)this->output.get_tick(i) - (long long)golden.output.get_tick(j);
+                        if (d > this->max_line_delay_ticks)
+                            this->max_line_delay_ticks = d;
                         if (this->delay_amount == 0 || this->delay_amount < i - j) {
                             this->delayed_str = this->output[i];
                             this->delay_amount = i - j;
+                            this->delay_ticks = d;
                         }
+                    }
                     out_of_order = true;
                     break;
                 }
             }
         }
         if (out_of_order == false) {
-            std::string tmp1 = this->output[i];
-            std::string tmp2 = error_pattern;
-
-            std::for_each(tmp1.begin(), tmp1.end(), [](char& c) {
-                c = ::toupper(c);
-                });
-            std::for_each(tmp2.begin(), tmp2.end(), [](char& c) {
-                c = ::toupper(c);
-                });
-
             if (error_pattern == "") {
                 this->error_matched_str = this->output[i];
                 return SDC;
             }
-            else if (tmp1.find(tmp2, 0) != -1) {
+            else if (is_error_line(this->output[i])) {
                 this->error_matched_str = this->output[i];
                 return SDC;
             }
@@ -237,19 +856,85 @@ SimulatorError SimulatorRun::compare_with_golden(const SimulatorRun& golden, std
     return DELAY;
 }
 
-std::vector<DataStructure> SimulatorRun::get_data_structures() const {
-    return this->data_structures;
+// A periodic task or timer of the golden run activated later than in the golden and reference runs
+// (the worst one is kept). Tasks and timers which are not in the golden run are not compared.
+bool SimulatorRun::find_timing_violation(const SimulatorRun& golden) {
+    unsigned long worst_excess = 0;
+
+    this->timing_violation_key = "";
+    for (auto const& d : this->deadline_stats) {
+        auto g = golden.deadline_stats.find(d.first);
+        if (g == golden.deadline_stats.end())
+            continue;
+
+        unsigned long bound = std::max(g->second.worst_lateness, golden.tolerance.get_worst_lateness(d.first)) + DEADLINE_LATENESS_MARGIN_TICKS;
+        if (d.second.worst_lateness > bound && d.second.worst_lateness - bound > worst_excess) {
+            worst_excess = d.second.worst_lateness - bound;
+            this->timing_violation_key = d.first;
+            this->timing_violation_lateness = d.second.worst_lateness;
+            this->timing_violation_bound = bound;
+        }
+    }
+
+    return this->timing_violation_key != "";
+}
+
+// Learn the non-determinism of this (golden) run from a reference run of the same workload
+void SimulatorRun::add_reference(SimulatorRun& ref) {
+    if (this->tolerance.get_reference_runs() == 0) {
+        this->tolerance.init(this->output, this->duration(), this->get_native_exit_code());
+        for (auto const& d : this->deadline_stats)
+            this->tolerance.add_lateness(d.first, d.second.worst_lateness);
+    }
+    this->tolerance.add_reference(this->output, ref.output, ref.duration(), ref.get_native_exit_code());
+    for (auto const& d : ref.deadline_stats)
+        this->tolerance.add_lateness(d.first, d.second.worst_lateness);
+}
+
+ToleranceModel& SimulatorRun::get_tolerance() {
+    return this->tolerance;
+}
+
+const ToleranceModel& SimulatorRun::get_tolerance() const {
+    return this->tolerance;
 }
 
-DataStructure SimulatorRun::get_ds_by_id(int id) const {
-    for (auto ds : this->data_structures) {
-        if (ds.get_id() == id)
-            return ds;
+// Same data structures (and kernel symbols) at the same addresses
+bool SimulatorRun::same_layout(const SimulatorRun& other) const {
+    const std::vector<DataStructure>& mine = this->structures->get_structures();
+    const std::vector<DataStructure>& others = other.structures->get_structures();
+
+    if (this->structures == other.structures)
+        return !mine.empty();
+    if (mine.empty() || mine.size() != others.size())
+        return false;
+
+    for (size_t i = 0; i < mine.size(); i++) {
+        const DataStructure& a = mine[i];
+        const DataStructure& b = others[i];
+        if (a.get_id() != b.get_id() || a.get_type() != b.get_type() || a.get_address() != b.get_address() || a.get_name() != b.get_name())
+            return false;
     }
+
+    return this->structures->get_symbols() == other.structures->get_symbols();
+}
+
+const std::vector<DataStructure>& SimulatorRun::get_data_structures() const {
+    return this->structures->get_structures();
+}
+
+const DataStructure& SimulatorRun::get_ds_by_id(int id) const {
+    const DataStructure* ds = this->structures->find(id);
+    if (ds != nullptr)
+        return *ds;
     std::cerr << "Error: Data structure with id: " << id << " not found." << std::endl;
     exit(2);
 }
 
+void* SimulatorRun::get_symbol(const std::string& name) const {
+    return this->structures->get_symbol(name);
+}
+
 std::chrono::steady_clock::time_point SimulatorRun::get_begin_time() const {
     return this->begin_time;
 }
@@ -258,6 +943,10 @@ long long SimulatorRun::get_pid() const {
     return this->c.id();
 }
 
+std::string SimulatorRun::get_workload() const {
+    return this->workload;
+}
+
 int SimulatorRun::get_native_exit_code() const {
     return this->c.native_exit_code();
 }
@@ -274,6 +963,114 @@ std::string SimulatorRun::get_delayed_str() const {
     return this->delayed_str;
 }
 
+std::string SimulatorRun::get_timing_violation_key() const {
+    return this->timing_violation_key;
+}
+
+unsigned long SimulatorRun::get_timing_violation_lateness() const {
+    return this->timing_violation_lateness;
+}
+
+unsigned long SimulatorRun::get_timing_violation_bound() const {
+    return this->timing_violation_bound;
+}
+
+std::map<std::string, DeadlineStats> SimulatorRun::get_deadline_stats() const {
+    return this->deadline_stats;
+}
+
 int SimulatorRun::get_delay_amount() const {
     return delay_amount;
 }
+
+long long SimulatorRun::get_delay_ticks() const {
+    return this->delay_ticks;
+}
+
+long long SimulatorRun::get_first_divergence_line() const {
+    return this->first_divergence_line;
+}
+
+unsigned long SimulatorRun::get_first_divergence_tick() const {
+    return this->first_divergence_tick;
+}
+
+long long SimulatorRun::get_max_line_delay_ticks() const {
+    return this->max_line_delay_ticks;
+}
+
+std::vector<TaskStats> SimulatorRun::get_task_stats() const {
+    return this->task_stats;
+}
+
+unsigned long SimulatorRun::get_total_run_time_us() const {
+    return this->total_run_time_us;
+}
+
+std::vector<uint64_t> SimulatorRun::get_state_digests() const {
+    return this->state_digests;
+}
+
+uint64_t SimulatorRun::get_trigger_count(int hook) const {
+    if (hook < 0 || (size_t)hook >= this->trigger_counts.size())
+        return 0;
+    return this->trigger_counts[hook];
+}
+
+bool SimulatorRun::stopped_early() const {
+    // The done event tells a stop on a masked state from a process that just exited with the same code
+    if (this->sync_read_fd != -1)
+        return this->done_received && this->done_payload == STATE_DIGEST_MASKED_EXIT_CODE;
+    return this->c.exit_code() == STATE_DIGEST_MASKED_EXIT_CODE;
+}
+
+bool SimulatorRun::reported_done() const {
+    return this->done_received;
+}
+
+unsigned long SimulatorRun::get_progress_cycles() const {
+    return this->progress_cycles;
+}
+
+std::string SimulatorRun::get_trace_path() const {
+#if defined TRACE_RECORDER
+    std::string trace_f_pref = TRACE_FILE_PREFIX;
+    return "output/" + trace_f_pref + std::to_string(this->c.id()) + ".bin";
+#else
+    return "";
+#endif
+}
+
+void SimulatorRun::discard_trace() {
+    std::string path = this->get_trace_path();
+
+    // The trace is missing if the simulator was killed or crashed
+    if (path != "")
+        remove(path.c_str());
+}
+
+PhaseProfile& SimulatorRun::get_profile() {
+    return this->profile;
+}
+
+const char* get_outcome_name(int se) {
+    switch (se)
+    {
+    case MASKED:
+        return "masked";
+    case SDC:
+        return "sdc";
+    case DELAY:
+        return "delay";
+    case HANG:
+        return "hang";
+    case CRASH:
+        return "crash";
+    case TIMING_VIOLATION:
+        return "timing_violation";
+    case NOT_INJECTED:
+        return "not_injected";
+    default:
+        return "invalid";
+    }
+}
@@ -13,15 +13,34 @@
 #include <chrono>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 #include <boost/process.hpp>
 #include <boost/process/extend.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/sync/named_semaphore.hpp>
 
 #include "DataStructure.h"
+#include "OutputLines.h"
+#include "PhaseProfile.h"
+#include "ToleranceModel.h"
 #include "simulator_config.h"
-
-#define DEADLOCK_TIME_FACTOR    2
+#include "state_digest.h"
+#include "heap_arena.h"
+#include "trigger.h"
+#include "workload.h"
+#include "SimulatorLibrary.h"
+#include "sync.h"
+
+// A run is considered hung after the HANG_TIMEOUT_PERCENTILE of the golden and reference durations
+// plus HANG_TIMEOUT_MARGIN_PERCENT, unless it keeps reporting progress: then it gets one more
+// check cycle (at the pace it is running, plus the margin) at every report, up to HANG_TIMEOUT_MAX_FACTOR times the timeout
+#define HANG_TIMEOUT_PERCENTILE         0.99
+#define HANG_TIMEOUT_MARGIN_PERCENT     20
+#define HANG_TIMEOUT_MAX_FACTOR         4
+
+// Lateness (ticks) of a periodic task or timer tolerated beyond the worst one of the golden and reference runs
+#define DEADLINE_LATENESS_MARGIN_TICKS  2
 
 namespace bp = boost::process;
 namespace bi = boost::interprocess;
@@ -31,56 +50,179 @@ enum SimulatorError {
     SDC,
     DELAY,
     HANG,
-    CRASH
+    CRASH,
+    // Appended: the outcomes are stored by value in the campaign journals
+    TIMING_VIOLATION,
+    // Nothing has been injected (e.g. the stack of a deleted task): the trial is journaled, but it is not an outcome
+    NOT_INJECTED
 };
 
+// Name of an outcome, as in the results of the bench and of the analysis (e.g. "timing_violation")
+const char* get_outcome_name(int se);
+
+/* Run time stats of a simulator task, written by the simulator when it exits */
+typedef struct {
+    unsigned long number;
+    std::string name;
+    unsigned long run_time_us;
+    unsigned long switches;
+    unsigned long stack_high_water_mark;
+} TaskStats;
+
+/* Activations of the periodic tasks and timers with the same name and period, written by the simulator when it exits */
+typedef struct {
+    unsigned long activations;
+    unsigned long misses;
+    unsigned long worst_lateness;
+} DeadlineStats;
+
+/*
+* A simulator run, from its spawn to the comparison of its output with the golden one.
+* A run can be init() again once it is over: the trials of a process reuse one run, which keeps
+* the memory of its output and stats, and shares the data structure table of the golden run
+* when the address maps match (the per-trial overhead doesn't grow with the output or the registry).
+*/
 class SimulatorRun {
 private:
     bp::child c;
 
-    std::vector<DataStructure> data_structures;
+    // Workload manifest passed to the simulator (empty: the one of the build)
+    std::string workload;
+
+    std::shared_ptr<const DataStructureTable> structures;
 
-    std::vector<std::string> output;
+    // Output lines with the kernel tick and the monotonic time (ns) at which they were printed
+    OutputLines output;
 
     std::chrono::steady_clock::time_point begin_time;
     std::chrono::steady_clock::time_point end_time;
-    std::chrono::steady_clock::duration* loaded_duration;
+    bool duration_loaded;
+    std::chrono::steady_clock::duration loaded_duration;
 
     std::string error_matched_str;
     std::string delayed_str;
     int delay_amount;
+    long long delay_ticks;
+
+    unsigned long injection_tick;
+    long long first_divergence_line;
+    unsigned long first_divergence_tick;
+    long long max_line_delay_ticks;
+
+    // By "<task|timer> <name> (<period>)"
+    std::map<std::string, DeadlineStats> deadline_stats;
+    std::string timing_violation_key;
+    unsigned long timing_violation_lateness;
+    unsigned long timing_violation_bound;
+
+    std::vector<TaskStats> task_stats;
+    unsigned long total_run_time_us;
+
+    // Digest of the kernel state at each check cycle
+    std::vector<uint64_t> state_digests;
 
+    // Occurrences of each trigger hook (see trigger.h) in the whole run
+    std::vector<uint64_t> trigger_counts;
+
+    PhaseProfile profile;
+
+    // Non-determinism of the golden run, learnt from its reference runs
+    ToleranceModel tolerance;
+
+    // Handshake with the simulator (see sync.h): the injector ends of the pipes
+    int sync_read_fd;
+    int sync_write_fd;
+    bool done_received;
+    uint64_t done_payload;
+    bool stopped_at_trigger;
+
+    // Check cycles reported done by the simulator, and when the last one has been received
+    unsigned long progress_cycles;
+    std::chrono::steady_clock::time_point progress_time;
+
+    void reset();
+    bool sync_receive(SyncMessage& msg);
+    bool sync_poll(std::chrono::steady_clock::time_point deadline, SyncMessage& msg, bool& timed_out);
+    bool record_message(const SyncMessage& msg);
+    bool receive_until(std::chrono::steady_clock::time_point deadline, bool extend, std::chrono::steady_clock::time_point limit);
     void read_data_structures();
+    bool same_heap_arena(const SimulatorRun& layout) const;
+    void read_task_stats(const std::string& pid_str);
+    void read_deadline_stats(const std::string& pid_str);
+    void read_state_digests(const std::string& pid_str);
+    void read_trigger_counts(const std::string& pid_str);
+    void find_first_divergence(const SimulatorRun& golden, size_t golden_size);
 
 public:
     SimulatorRun();
     ~SimulatorRun();
 
     // Delete copy constructor and copy assignment
-    // Allow only move constructor and assignment
-    void init(std::string sim_path);
-    void start();
+    SimulatorRun(const SimulatorRun&) = delete;
+    SimulatorRun& operator=(const SimulatorRun&) = delete;
+
+    // If layout is set (a run with the same address map, e.g. the golden run), its data structures
+    // are reused instead of reading the ones logged by the simulator (unless the heap arena has moved)
+    void init(std::string sim_path, std::string workload = "", const SimulatorRun* layout = nullptr);
+    // If hold_handshake is set, the simulator can be stopped at an armed trigger and resumed (see wait_trigger)
+    void start(bool hold_handshake = false);
+    bool wait_trigger(std::chrono::steady_clock::time_point deadline);
+    void resume();
     std::chrono::steady_clock::duration duration();
     void load_duration(unsigned long ms);
+    void load_workload(const std::string& workload);
     std::error_code wait();
     bool wait_for(const std::chrono::steady_clock::duration& rel_time, std::error_code& ec);
+    bool wait_progressing(const std::chrono::steady_clock::duration& timeout, std::error_code& ec);
     void terminate();
     void save_output(int* pid);
     void show_output();
     void print_stats(bool use_logger);
+    void print_task_stats(const SimulatorRun* golden, bool use_logger);
 
+    void set_injection_tick(unsigned long tick);
     SimulatorError compare_with_golden(const SimulatorRun& golden, std::string error_pattern);
+    bool find_timing_violation(const SimulatorRun& golden);
+
+    void add_reference(SimulatorRun& ref);
+    ToleranceModel& get_tolerance();
+    const ToleranceModel& get_tolerance() const;
 
-    std::vector<DataStructure> get_data_structures() const;
-    DataStructure get_ds_by_id(int id) const;
+    bool same_layout(const SimulatorRun& other) const;
+    const std::vector<DataStructure>& get_data_structures() const;
+    const DataStructure& get_ds_by_id(int id) const;
+    void* get_symbol(const std::string& name) const;
     std::chrono::steady_clock::time_point get_begin_time() const;
     long long get_pid() const;
+    std::string get_workload() const;
     int get_native_exit_code() const;
     bool is_running();
 
     std::string get_error_matched_str() const;
     std::string get_delayed_str() const;
     int get_delay_amount() const;
+    long long get_delay_ticks() const;
+    long long get_first_divergence_line() const;
+    unsigned long get_first_divergence_tick() const;
+    long long get_max_line_delay_ticks() const;
+    std::string get_timing_violation_key() const;
+    unsigned long get_timing_violation_lateness() const;
+    unsigned long get_timing_violation_bound() const;
+    std::map<std::string, DeadlineStats> get_deadline_stats() const;
+
+    std::vector<TaskStats> get_task_stats() const;
+    unsigned long get_total_run_time_us() const;
+
+    std::vector<uint64_t> get_state_digests() const;
+    uint64_t get_trigger_count(int hook) const;
+    bool stopped_early() const;
+    bool reported_done() const;
+    unsigned long get_progress_cycles() const;
+
+    std::string get_trace_path() const;
+    void discard_trace();
+
+    PhaseProfile& get_profile();
 };
 
 
@@ -0,0 +1,293 @@
+#include "ToleranceModel.h"
+
+#include "loguru.hpp"
+#include "simulator_config.h"
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Magic number at the beginning of a saved model (format version included)
+#define TOLERANCE_MODEL_MAGIC    "FITOLR03"
+
+// The line with its numbers masked (the text of the statement which printed it) and the numbers
+static std::string line_shape(std::string_view line, std::vector<uint64_t>& numbers) {
+    std::string shape;
+
+    numbers.clear();
+    for (size_t i = 0; i < line.size(); i++) {
+        if (!isdigit((unsigned char)line[i])) {
+            shape += line[i];
+            continue;
+        }
+        if (shape.empty() || shape.back() != '#') {
+            shape += '#';
+            numbers.push_back(0);
+        }
+        // Saturated: a longer number is out of any range seen anyway
+        uint64_t& n = numbers.back();
+        n = n > (UINT64_MAX - 9) / 10 ? UINT64_MAX : n * 10 + (uint64_t)(line[i] - '0');
+    }
+    return shape;
+}
+
+ToleranceModel::ToleranceModel() {
+    this->reference_runs = 0;
+    this->min_output_lines = 0;
+    this->max_output_lines = 0;
+}
+
+void ToleranceModel::init(const OutputLines& golden_output, std::chrono::steady_clock::duration golden_duration, int golden_exit_code) {
+    this->reference_runs = 0;
+    this->durations.assign(1, golden_duration);
+    this->exit_codes.clear();
+    this->exit_codes.insert(golden_exit_code);
+    this->min_output_lines = golden_output.size();
+    this->max_output_lines = golden_output.size();
+    this->reorderable_lines.clear();
+    this->variable_lines.clear();
+    this->worst_lateness.clear();
+}
+
+void ToleranceModel::add_reference(const OutputLines& golden_output, const OutputLines& output, std::chrono::steady_clock::duration duration, int exit_code) {
+    this->reference_runs++;
+    this->durations.push_back(duration);
+    this->exit_codes.insert(exit_code);
+    this->min_output_lines = std::min(this->min_output_lines, output.size());
+    this->max_output_lines = std::max(this->max_output_lines, output.size());
+
+    // Lines printed a different number of times (or with a different text) than in the golden run
+    std::map<std::string_view, int> counts;
+    std::vector<uint64_t> numbers;
+    for (size_t i = 0; i < golden_output.size(); i++)
+        counts[golden_output[i]]++;
+    for (size_t i = 0; i < output.size(); i++)
+        counts[output[i]]--;
+    for (auto const& c : counts) {
+        if (c.second != 0)
+            this->variable_lines.emplace(line_shape(c.first, numbers), std::vector<std::pair<uint64_t, uint64_t>>());
+    }
+
+    // The numbers of these statements in both runs
+    for (const OutputLines* lines : { &golden_output, &output }) {
+        for (size_t i = 0; i < lines->size(); i++) {
+            auto it = this->variable_lines.find(line_shape((*lines)[i], numbers));
+            if (it == this->variable_lines.end())
+                continue;
+            auto& ranges = it->second;
+            if (ranges.empty()) {
+                for (uint64_t n : numbers)
+                    ranges.push_back(std::make_pair(n, n));
+                continue;
+            }
+            for (size_t k = 0; k < numbers.size(); k++) {
+                ranges[k].first = std::min(ranges[k].first, numbers[k]);
+                ranges[k].second = std::max(ranges[k].second, numbers[k]);
+            }
+        }
+    }
+
+    // The other lines at a different position have been reordered
+    size_t n = std::min(golden_output.size(), output.size());
+    for (size_t i = 0; i < n; i++) {
+        if (output[i] == golden_output[i])
+            continue;
+        if (!this->may_vary(output[i]))
+            this->reorderable_lines.insert(std::string(output[i]));
+        if (!this->may_vary(golden_output[i]))
+            this->reorderable_lines.insert(std::string(golden_output[i]));
+    }
+}
+
+// Worst lateness (ticks) of the activations of a periodic task or timer, by "<task|timer> <name> (<period>)"
+void ToleranceModel::add_lateness(const std::string& key, unsigned long ticks) {
+    unsigned long& worst = this->worst_lateness[key];
+    worst = std::max(worst, ticks);
+}
+
+std::string ToleranceModel::get_path(long long golden_pid) const {
+    std::string s1 = TOLERANCE_MODEL_FILE_PREFIX;
+    std::string s2 = std::to_string(golden_pid);
+    std::string s3 = ".txt";
+    return "output/" + s1 + s2 + s3;
+}
+
+void ToleranceModel::save(long long golden_pid) const {
+    std::string path = this->get_path(golden_pid);
+    std::ofstream out(path);
+
+    if (!out.is_open()) {
+        std::cerr << "Unable to open " << path << " for writing the tolerance model." << std::endl;
+        exit(1);
+    }
+
+    out << TOLERANCE_MODEL_MAGIC << "\n";
+    out << "runs " << this->reference_runs << "\n";
+    out << "output_lines " << this->min_output_lines << " " << this->max_output_lines << "\n";
+    out << "exit_codes";
+    for (int code : this->exit_codes)
+        out << " " << code;
+    out << "\n";
+    out << "durations_ns";
+    for (auto const& d : this->durations)
+        out << " " << std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    out << "\n";
+    // The lines last, one per line (the text may contain spaces)
+    for (auto const& line : this->reorderable_lines)
+        out << "reorder\t" << line << "\n";
+    // "vary", the ranges of the numbers ("min-max" separated by spaces), then the text
+    for (auto const& v : this->variable_lines) {
+        out << "vary\t";
+        for (size_t k = 0; k < v.second.size(); k++)
+            out << (k > 0 ? " " : "") << v.second[k].first << "-" << v.second[k].second;
+        out << "\t" << v.first << "\n";
+    }
+    for (auto const& l : this->worst_lateness)
+        out << "lateness\t" << l.second << "\t" << l.first << "\n";
+}
+
+// Returns false if no model has been saved for the golden run
+bool ToleranceModel::load(long long golden_pid) {
+    std::ifstream in(this->get_path(golden_pid));
+    std::string line;
+
+    if (!in.is_open() || !std::getline(in, line) || line != TOLERANCE_MODEL_MAGIC)
+        return false;
+
+    this->durations.clear();
+    this->exit_codes.clear();
+    this->reorderable_lines.clear();
+    this->variable_lines.clear();
+    this->worst_lateness.clear();
+
+    while (std::getline(in, line)) {
+        size_t tab = line.find('\t');
+        if (tab != std::string::npos) {
+            std::string tag = line.substr(0, tab);
+            if (tag == "reorder")
+                this->reorderable_lines.insert(line.substr(tab + 1));
+            else if (tag == "vary") {
+                size_t shape_tab = line.find('\t', tab + 1);
+                if (shape_tab == std::string::npos)
+                    continue;
+                std::stringstream ss(line.substr(tab + 1, shape_tab - tab - 1));
+                std::vector<std::pair<uint64_t, uint64_t>> ranges;
+                uint64_t low, high;
+                char dash;
+                while (ss >> low >> dash >> high)
+                    ranges.push_back(std::make_pair(low, high));
+                this->variable_lines[line.substr(shape_tab + 1)] = ranges;
+            }
+            else if (tag == "lateness") {
+                size_t key_tab = line.find('\t', tab + 1);
+                if (key_tab != std::string::npos)
+                    this->worst_lateness[line.substr(key_tab + 1)] = std::stoul(line.substr(tab + 1, key_tab - tab - 1));
+            }
+            continue;
+        }
+
+        std::stringstream ss(line);
+        std::string key;
+        ss >> key;
+        if (key == "runs") {
+            ss >> this->reference_runs;
+        }
+        else if (key == "output_lines") {
+            ss >> this->min_output_lines >> this->max_output_lines;
+        }
+        else if (key == "exit_codes") {
+            int code;
+            while (ss >> code)
+                this->exit_codes.insert(code);
+        }
+        else if (key == "durations_ns") {
+            long long ns;
+            while (ss >> ns)
+                this->durations.push_back(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(ns)));
+        }
+    }
+
+    return true;
+}
+
+int ToleranceModel::get_reference_runs() const {
+    return this->reference_runs;
+}
+
+bool ToleranceModel::may_reorder(std::string_view line) const {
+    return this->reorderable_lines.find(line) != this->reorderable_lines.end();
+}
+
+bool ToleranceModel::may_vary(std::string_view line) const {
+    std::vector<uint64_t> numbers;
+    auto it = this->variable_lines.find(line_shape(line, numbers));
+
+    if (it == this->variable_lines.end() || it->second.size() != numbers.size())
+        return false;
+    for (size_t k = 0; k < numbers.size(); k++) {
+        if (numbers[k] < it->second[k].first || numbers[k] > it->second[k].second)
+            return false;
+    }
+    return true;
+}
+
+bool ToleranceModel::output_size_seen(size_t lines) const {
+    return this->reference_runs > 0 && lines >= this->min_output_lines && lines <= this->max_output_lines;
+}
+
+bool ToleranceModel::exit_code_seen(int exit_code) const {
+    return this->reference_runs > 0 && this->exit_codes.find(exit_code) != this->exit_codes.end();
+}
+
+unsigned long ToleranceModel::get_worst_lateness(const std::string& key) const {
+    auto it = this->worst_lateness.find(key);
+    return it != this->worst_lateness.end() ? it->second : 0;
+}
+
+// Nearest rank percentile
+std::chrono::steady_clock::duration ToleranceModel::get_duration_percentile(double p) const {
+    if (this->durations.empty())
+        return std::chrono::steady_clock::duration::zero();
+
+    std::vector<std::chrono::steady_clock::duration> sorted = this->durations;
+    std::sort(sorted.begin(), sorted.end());
+
+    size_t rank = (size_t)(p * sorted.size() + 0.999999);
+    rank = std::min(std::max(rank, (size_t)1), sorted.size());
+    return sorted[rank - 1];
+}
+
+std::chrono::steady_clock::duration ToleranceModel::get_max_duration() const {
+    return this->get_duration_percentile(1.0);
+}
+
+void ToleranceModel::print_stats(bool use_logger) const {
+    using namespace std;
+
+    stringstream ss;
+    auto to_ms = [](std::chrono::steady_clock::duration d) {
+        return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+
+    ss << "Tolerance model from " << this->reference_runs << " reference runs:\n";
+    ss << "Duration (ms): min " << to_ms(this->get_duration_percentile(0)) << ", median " << to_ms(this->get_duration_percentile(0.5))
+        << ", max " << to_ms(this->get_max_duration()) << "\n";
+    ss << "Output lines: " << this->min_output_lines << " - " << this->max_output_lines << "\n";
+    ss << "Exit codes:";
+    for (int code : this->exit_codes)
+        ss << " " << code;
+    ss << "\n";
+    ss << "Lines which may be reordered: " << this->reorderable_lines.size() << ", which may vary: " << this->variable_lines.size() << "\n";
+    unsigned long worst = 0;
+    for (auto const& l : this->worst_lateness)
+        worst = std::max(worst, l.second);
+    ss << "Periodic tasks and timers: " << this->worst_lateness.size() << ", worst lateness " << worst << " ticks\n";
+
+    if (use_logger) {
+        RAW_LOG_F(INFO, "%s", ss.str().c_str());
+    }
+    else {
+        cout << ss.str() << endl;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef FREERTOS_FAULTINJECTOR_TOLERANCEMODEL_H
+#define FREERTOS_FAULTINJECTOR_TOLERANCEMODEL_H
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OutputLines.h"
+
+/*
+* Non-determinism of the golden execution, learnt from reference runs of the same workload
+* executed concurrently with (after) the golden one:
+*   - the output lines which have been printed in a different order (jitter between tasks)
+*   - the output lines which are not always printed, or printed with different numbers: by the text
+*     around the numbers, with the range of every number seen (a number out of it is still a difference)
+*   - the spread of the durations, the output sizes and the exit codes
+*   - the worst lateness of every periodic task and timer
+* An injected run differing from the golden one only within these bounds is not a failure.
+* The model is saved next to the golden output, so that the parallel instances can load it.
+*/
+class ToleranceModel {
+private:
+    int reference_runs;
+
+    std::vector<std::chrono::steady_clock::duration> durations;
+    std::set<int> exit_codes;
+    size_t min_output_lines;
+    size_t max_output_lines;
+
+    std::set<std::string, std::less<>> reorderable_lines;
+    std::map<std::string, std::vector<std::pair<uint64_t, uint64_t>>> variable_lines;
+
+    std::map<std::string, unsigned long> worst_lateness;
+
+    std::string get_path(long long golden_pid) const;
+
+public:
+    ToleranceModel();
+
+    void init(const OutputLines& golden_output, std::chrono::steady_clock::duration golden_duration, int golden_exit_code);
+    void add_reference(const OutputLines& golden_output, const OutputLines& output, std::chrono::steady_clock::duration duration, int exit_code);
+    void add_lateness(const std::string& key, unsigned long ticks);
+
+    void save(long long golden_pid) const;
+    bool load(long long golden_pid);
+
+    int get_reference_runs() const;
+    bool may_reorder(std::string_view line) const;
+    bool may_vary(std::string_view line) const;
+    bool output_size_seen(size_t lines) const;
+    bool exit_code_seen(int exit_code) const;
+    unsigned long get_worst_lateness(const std::string& key) const;
+
+    // Durations of the golden and reference runs (p in [0, 1])
+    std::chrono::steady_clock::duration get_duration_percentile(double p) const;
+    std::chrono::steady_clock::duration get_max_duration() const;
+
+    void print_stats(bool use_logger) const;
+};
+
+#endif //FREERTOS_FAULTINJECTOR_TOLERANCEMODEL_H
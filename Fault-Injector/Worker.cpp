@@ -0,0 +1,117 @@
+#include "Worker.h"
+
+#include "SimulatorRun.h"
+#include "FaultSpace.h"
+#include "Campaign.h"
+#include "loguru.hpp"
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <thread>
+
+Worker::Worker(const std::string& host, unsigned short port) {
+    this->host = host;
+    this->port = port;
+}
+
+void Worker::run(const std::string& sim_path) {
+    ba::io_context io;
+    ba::ip::tcp::socket socket(io);
+    ba::ip::tcp::resolver resolver(io);
+    boost::system::error_code ec;
+    uint32_t type;
+    std::vector<char> payload;
+
+    ba::connect(socket, resolver.resolve(this->host, std::to_string(this->port), ec), ec);
+    if (ec) {
+        std::cerr << "Unable to connect to the coordinator " << this->host << ":" << this->port << ": " << ec.message() << std::endl;
+        exit(1);
+    }
+    socket.set_option(ba::ip::tcp::no_delay(true), ec);
+
+    uint32_t version = CAMPAIGN_PROTOCOL_VERSION;
+    if (!send_message(socket, MSG_HELLO, &version, sizeof(version)) || !receive_message(socket, type, payload) ||
+        type != MSG_SPEC || !decode_campaign_spec(payload, this->spec)) {
+        std::cerr << "The coordinator " << this->host << ":" << this->port << " didn't send a valid campaign (different version?)" << std::endl;
+        exit(1);
+    }
+
+    LOG_F(INFO, "Connected to the coordinator %s:%u: %llu trials on the data structure %d", this->host.c_str(), this->port,
+        (unsigned long long)this->spec.trials, this->spec.struct_id);
+
+    // Golden run of this host, with the workload of the campaign
+    SimulatorRun golden_run;
+    std::map<int, size_t> sizes;
+
+    LOG_F(INFO, "Executing the simulator and saving the golden execution...");
+    golden_run.init(sim_path, this->spec.workload);
+    probe_exploded_sizes(golden_run, sizes);
+    golden_run.start();
+    golden_run.wait();
+    golden_run.save_output(nullptr);
+    RAW_LOG_F(INFO, "Golden run stats:");
+    golden_run.print_stats(true);
+#if defined GOLDEN_REFERENCE_RUNS
+    run_reference_runs(sim_path, golden_run, GOLDEN_REFERENCE_RUNS);
+    golden_run.get_tolerance().print_stats(true);
+#endif
+
+    // The fault space must be the one of the coordinator
+    // (sized on the largest instances of its runs: the sizes of this host before the scheduler starts can't exceed it)
+    if (sizes.find(this->spec.struct_id) == sizes.end() || sizes[this->spec.struct_id] > this->spec.exploded_size) {
+        std::cerr << "The data structure " << this->spec.struct_id << " is not the one of the coordinator (a different build?)" << std::endl;
+        exit(1);
+    }
+    FaultSpace fault_space;
+    fault_space.add_structure(this->spec.struct_id, this->spec.exploded_size);
+    fault_space.init(this->spec.max_time_ms, this->spec.key);
+
+    // Reused from a trial to the next one
+    SimulatorRun sr;
+
+    LOG_F(INFO, "-- Injections start --");
+    while (true) {
+        if (!send_message(socket, MSG_GET_SHARD, nullptr, 0) || !receive_message(socket, type, payload)) {
+            std::cerr << "Connection to the coordinator lost." << std::endl;
+            exit(1);
+        }
+
+        if (type == MSG_DONE)
+            break;
+        if (type == MSG_WAIT) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(CAMPAIGN_WAIT_MS));
+            continue;
+        }
+        if (type != MSG_SHARD || payload.size() != sizeof(CampaignShard)) {
+            std::cerr << "Invalid message from the coordinator (type " << type << ")." << std::endl;
+            exit(1);
+        }
+
+        CampaignShard shard;
+        memcpy(&shard, payload.data(), sizeof(shard));
+
+        // The end of the shard can move back (trials stolen by another worker) at every ack
+        for (uint64_t i = shard.begin; i < shard.end; i++) {
+            LOG_F(INFO, "Injection Try #%llu / %llu ...", (unsigned long long)i + 1, (unsigned long long)this->spec.trials);
+
+            bool sample_memory = this->spec.sample_every > 0 && i % this->spec.sample_every == 0;
+            auto begin = std::chrono::steady_clock::now();
+            SimulatorError se = run_injection_trial(sim_path, golden_run, sr, fault_space.at(i), this->spec.error_pattern, sample_memory, this->spec.trigger_hook);
+            auto duration = std::chrono::steady_clock::now() - begin;
+
+            LOG_F(INFO, "Injection finished.");
+            LOG_F(INFO, "----------------------\n");
+
+            TrialResult result = { i, (int32_t)se, 0, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() };
+            if (!send_message(socket, MSG_RESULT, &result, sizeof(result)) || !receive_message(socket, type, payload) ||
+                type != MSG_RESULT_ACK || payload.size() != sizeof(shard.end)) {
+                std::cerr << "Connection to the coordinator lost." << std::endl;
+                exit(1);
+            }
+            memcpy(&shard.end, payload.data(), sizeof(shard.end));
+        }
+    }
+
+    LOG_F(INFO, "The coordinator has no more trials: campaign finished");
+}
@@ -0,0 +1,28 @@
+#ifndef FREERTOS_FAULTINJECTOR_WORKER_H
+#define FREERTOS_FAULTINJECTOR_WORKER_H
+
+#include <string>
+
+#include "CampaignProtocol.h"
+
+#define WORKER_ARG          "--worker"
+
+/*
+* Runs the trials of a campaign served by a coordinator (see CampaignProtocol.h), one at a time.
+* The worker makes its own golden run with the workload of the campaign, then pulls shards
+* and sends back the outcome of every trial until the coordinator has no more work.
+* Several workers can run on the same host (e.g. one per core).
+*/
+class Worker {
+private:
+    std::string host;
+    unsigned short port;
+    CampaignSpec spec;
+
+public:
+    Worker(const std::string& host, unsigned short port);
+
+    void run(const std::string& sim_path);
+};
+
+#endif //FREERTOS_FAULTINJECTOR_WORKER_H
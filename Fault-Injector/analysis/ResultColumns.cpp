@@ -0,0 +1,360 @@
+#include "ResultColumns.h"
+
+#include "CampaignJournal.h"
+#include "FaultSpace.h"
+#include "FreeRTOSInterface.h"
+#include "memory_logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+const char* get_result_dimension_name(int dim) {
+    switch (dim)
+    {
+    case DIM_STRUCTURE:
+        return "structure";
+    case DIM_FIELD:
+        return "field";
+    case DIM_BIT:
+        return "bit";
+    case DIM_TIME_BUCKET:
+        return "time_bucket";
+    default:
+        return "invalid";
+    }
+}
+
+// Run body(begin, end) on contiguous slices of [0, rows), one per thread
+static void parallel_for(size_t rows, unsigned int threads, const std::function<void(unsigned int, size_t, size_t)>& body) {
+    std::vector<std::thread> workers;
+    size_t slice = (rows + threads - 1) / threads;
+
+    for (unsigned int t = 0; t < threads; t++) {
+        size_t begin = std::min(rows, t * slice);
+        size_t end = std::min(rows, begin + slice);
+        workers.emplace_back(body, t, begin, end);
+    }
+    for (auto& w : workers)
+        w.join();
+}
+
+uint32_t ResultColumns::intern_structure(const std::string& name) {
+    auto it = this->structure_ids.find(name);
+    if (it != this->structure_ids.end())
+        return it->second;
+    this->structure_names.push_back(name);
+    return this->structure_ids[name] = (uint32_t)(this->structure_names.size() - 1);
+}
+
+uint32_t ResultColumns::intern_field(const std::string& name) {
+    auto it = this->field_ids.find(name);
+    if (it != this->field_ids.end())
+        return it->second;
+    this->field_names.push_back(name);
+    return this->field_ids[name] = (uint32_t)(this->field_names.size() - 1);
+}
+
+// Append the finished trials of a journal. Returns false if the file is not a journal.
+bool ResultColumns::add_journal(const std::string& path, unsigned int threads) {
+    CampaignJournal journal;
+
+    if (!journal.load(path) || !journal.has_config())
+        return false;
+
+    CampaignSpec spec = journal.get_config();
+    std::vector<TrialResult> trials = journal.get_trials();
+
+    // The same fault space of the campaign: the fault point of a trial is the one at its index
+    FaultSpace fault_space;
+    fault_space.add_structure(spec.struct_id, spec.exploded_size);
+    fault_space.init(spec.max_time_ms, spec.key);
+
+    // Field of every byte of the fixed part (journals written before the structure was recorded have none)
+    std::string structure_name = std::to_string(spec.struct_id);
+    std::vector<uint32_t> byte_fields;
+    uint32_t exploded_field;
+    if (journal.has_structure()) {
+        CampaignStructure s = journal.get_structure();
+        bool has_layout = s.type != TYPE_STATIC_STACK && s.type != TYPE_TASK_STACK && s.type != TYPE_HEAP_ARENA;
+        structure_name += " " + s.name;
+        for (size_t byte = 0; byte < s.fixed_size; byte++) {
+            char field_name[128];
+            int field_kind;
+            if (has_layout && get_struct_field(s.type, byte, field_name, sizeof(field_name), &field_kind))
+                byte_fields.push_back(this->intern_field(structure_name + ": " + field_name));
+            else
+                byte_fields.push_back(this->intern_field(structure_name + ": (no field)"));
+        }
+        exploded_field = this->intern_field(structure_name + ": (exploded part)");
+    }
+    else {
+        exploded_field = this->intern_field(structure_name + ": (unknown)");
+    }
+    uint32_t structure_id = this->intern_structure(structure_name);
+
+    // Trials out of the fault space or with an unknown outcome (e.g. another build) are left out,
+    // as the ones without a fault are (they are counted apart)
+    this->not_injected += (uint64_t)std::count_if(trials.begin(), trials.end(), [](const TrialResult& r) { return r.outcome == NOT_INJECTED; });
+    trials.erase(std::remove_if(trials.begin(), trials.end(), [&](const TrialResult& r) {
+        return r.index >= fault_space.size() || r.outcome < 0 || r.outcome >= RESULT_OUTCOMES;
+    }), trials.end());
+
+    size_t first = this->size();
+    size_t rows = trials.size();
+    this->outcome.resize(first + rows);
+    this->bit.resize(first + rows);
+    this->structure.resize(first + rows, structure_id);
+    this->field.resize(first + rows);
+    this->time_ms.resize(first + rows);
+
+    parallel_for(rows, threads, [&](unsigned int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            FaultPoint fp = fault_space.at(trials[i].index);
+            this->outcome[first + i] = (uint8_t)trials[i].outcome;
+            this->bit[first + i] = (uint8_t)fp.bit;
+            this->field[first + i] = fp.byte < byte_fields.size() ? byte_fields[fp.byte] : exploded_field;
+            this->time_ms[first + i] = (uint32_t)fp.time_ms;
+        }
+    });
+
+    return true;
+}
+
+static void write_strings(FILE* fp, const std::vector<std::string>& strings) {
+    uint32_t count = (uint32_t)strings.size();
+    fwrite(&count, sizeof(count), 1, fp);
+    for (auto const& s : strings) {
+        uint32_t length = (uint32_t)s.size();
+        fwrite(&length, sizeof(length), 1, fp);
+        fwrite(s.data(), 1, length, fp);
+    }
+}
+
+// A count or a length beyond the end of the file (of size file_size) is from a corrupt file
+static bool read_strings(FILE* fp, long file_size, std::vector<std::string>& strings) {
+    uint32_t count;
+    if (fread(&count, sizeof(count), 1, fp) != 1 || count > (unsigned long)(file_size - ftell(fp)) / sizeof(uint32_t))
+        return false;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length;
+        if (fread(&length, sizeof(length), 1, fp) != 1 || length > (unsigned long)(file_size - ftell(fp)))
+            return false;
+        std::string s(length, '\0');
+        if (fread(&s[0], 1, length, fp) != length)
+            return false;
+        strings.push_back(s);
+    }
+    return true;
+}
+
+template <typename T>
+static void write_column(FILE* fp, const std::vector<T>& column) {
+    fwrite(column.data(), sizeof(T), column.size(), fp);
+}
+
+template <typename T>
+static bool read_column(FILE* fp, std::vector<T>& column, size_t first, size_t rows) {
+    column.resize(first + rows);
+    return fread(column.data() + first, sizeof(T), rows, fp) == rows;
+}
+
+/*
+* Columns file: the magic number, the number of rows, the number of trials left out as not injected,
+* the structure and field dictionaries (count, then length and characters of every name)
+* and the columns one after the other.
+*/
+void ResultColumns::save(const std::string& path) const {
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (fp == NULL) {
+        std::cerr << "Unable to open " << path << " for writing the result columns." << std::endl;
+        exit(1);
+    }
+
+    uint64_t rows = this->size();
+    fwrite(RESULT_COLUMNS_MAGIC, 1, 8, fp);
+    fwrite(&rows, sizeof(rows), 1, fp);
+    fwrite(&this->not_injected, sizeof(this->not_injected), 1, fp);
+    write_strings(fp, this->structure_names);
+    write_strings(fp, this->field_names);
+    write_column(fp, this->outcome);
+    write_column(fp, this->bit);
+    write_column(fp, this->structure);
+    write_column(fp, this->field);
+    write_column(fp, this->time_ms);
+
+    fclose(fp);
+}
+
+// Append the rows of a columns file. Returns false if the file is not a (complete) columns file.
+bool ResultColumns::load(const std::string& path) {
+    char magic[8];
+    uint64_t rows;
+    uint64_t not_injected;
+    std::vector<std::string> structures;
+    std::vector<std::string> fields;
+
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == NULL)
+        return false;
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, RESULT_COLUMNS_MAGIC, 8) != 0 || fread(&rows, sizeof(rows), 1, fp) != 1 ||
+        fread(&not_injected, sizeof(not_injected), 1, fp) != 1 || !read_strings(fp, file_size, structures) || !read_strings(fp, file_size, fields)) {
+        fclose(fp);
+        return false;
+    }
+
+    // The columns are the rest of the file: another number of rows is from a corrupt header
+    size_t row_size = sizeof(this->outcome[0]) + sizeof(this->bit[0]) + sizeof(this->structure[0]) + sizeof(this->field[0]) + sizeof(this->time_ms[0]);
+    if (rows != (uint64_t)(file_size - ftell(fp)) / row_size) {
+        fclose(fp);
+        return false;
+    }
+
+    size_t first = this->size();
+    bool valid = read_column(fp, this->outcome, first, rows) && read_column(fp, this->bit, first, rows) &&
+        read_column(fp, this->structure, first, rows) && read_column(fp, this->field, first, rows) &&
+        read_column(fp, this->time_ms, first, rows);
+    fclose(fp);
+
+    // The dictionary codes of the file become the ones of these columns
+    std::vector<uint32_t> structure_codes;
+    std::vector<uint32_t> field_codes;
+    for (auto const& s : structures)
+        structure_codes.push_back(this->intern_structure(s));
+    for (auto const& f : fields)
+        field_codes.push_back(this->intern_field(f));
+
+    for (size_t i = first; valid && i < first + rows; i++) {
+        if (this->structure[i] >= structure_codes.size() || this->field[i] >= field_codes.size() || this->outcome[i] >= RESULT_OUTCOMES) {
+            valid = false;
+            break;
+        }
+        this->structure[i] = structure_codes[this->structure[i]];
+        this->field[i] = field_codes[this->field[i]];
+    }
+
+    if (!valid) {
+        this->outcome.resize(first);
+        this->bit.resize(first);
+        this->structure.resize(first);
+        this->field.resize(first);
+        this->time_ms.resize(first);
+    }
+    else {
+        this->not_injected += not_injected;
+    }
+    return valid;
+}
+
+size_t ResultColumns::size() const {
+    return this->outcome.size();
+}
+
+uint64_t ResultColumns::get_not_injected() const {
+    return this->not_injected;
+}
+
+size_t ResultColumns::groups(ResultDimension dim, unsigned long bucket_ms) const {
+    switch (dim)
+    {
+    case DIM_STRUCTURE:
+        return this->structure_names.size();
+    case DIM_FIELD:
+        return this->field_names.size();
+    case DIM_BIT:
+        return 8;
+    case DIM_TIME_BUCKET:
+        return this->time_ms.empty() ? 0 : *std::max_element(this->time_ms.begin(), this->time_ms.end()) / bucket_ms + 1;
+    default:
+        return 0;
+    }
+}
+
+std::string ResultColumns::group_name(ResultDimension dim, size_t group, unsigned long bucket_ms) const {
+    switch (dim)
+    {
+    case DIM_STRUCTURE:
+        return this->structure_names[group];
+    case DIM_FIELD:
+        return this->field_names[group];
+    case DIM_BIT:
+        return std::to_string(group);
+    case DIM_TIME_BUCKET:
+        return std::to_string(group * bucket_ms) + "-" + std::to_string((group + 1) * bucket_ms) + " ms";
+    default:
+        return "";
+    }
+}
+
+/*
+* Histogram of the cells (group * RESULT_OUTCOMES + outcome) of the rows [begin, end), in blocks:
+* first the cells of the block, a branch-free loop over two contiguous columns which the compiler
+* vectorizes, then the increments, spread over RESULT_HISTOGRAM_LANES copies of the histogram.
+* The group is key / divisor, computed as (key + 0.5) * (1 / divisor) to stay a vector multiplication:
+* the half keeps an exact multiple of the divisor from being rounded down into the previous group.
+*/
+template <typename T>
+static void count_cells(const T* key, const uint8_t* outcome, size_t begin, size_t end, unsigned long divisor, uint64_t* histogram, size_t cells) {
+    uint32_t block[RESULT_BLOCK_ROWS];
+    double inverse = 1.0 / (double)divisor;
+
+    for (size_t b = begin; b < end; b += RESULT_BLOCK_ROWS) {
+        size_t n = std::min((size_t)RESULT_BLOCK_ROWS, end - b);
+        const T* k = key + b;
+        const uint8_t* o = outcome + b;
+
+        if (divisor == 1) {
+            for (size_t i = 0; i < n; i++)
+                block[i] = (uint32_t)k[i] * RESULT_OUTCOMES + o[i];
+        }
+        else {
+            for (size_t i = 0; i < n; i++)
+                block[i] = (uint32_t)(((double)k[i] + 0.5) * inverse) * RESULT_OUTCOMES + o[i];
+        }
+
+        size_t i = 0;
+        for (; i + RESULT_HISTOGRAM_LANES <= n; i += RESULT_HISTOGRAM_LANES) {
+            for (size_t lane = 0; lane < RESULT_HISTOGRAM_LANES; lane++)
+                histogram[lane * cells + block[i + lane]]++;
+        }
+        for (; i < n; i++)
+            histogram[block[i]]++;
+    }
+}
+
+std::vector<uint64_t> ResultColumns::breakdown(ResultDimension dim, unsigned long bucket_ms, unsigned int threads) const {
+    size_t cells = this->groups(dim, bucket_ms) * RESULT_OUTCOMES;
+    size_t rows = this->size();
+
+    // A private histogram (all its lanes) per thread, summed at the end
+    std::vector<std::vector<uint64_t>> histograms(threads, std::vector<uint64_t>(cells * RESULT_HISTOGRAM_LANES, 0));
+
+    parallel_for(rows, threads, [&](unsigned int t, size_t begin, size_t end) {
+        uint64_t* histogram = histograms[t].data();
+        const uint8_t* outcome = this->outcome.data();
+
+        if (dim == DIM_STRUCTURE)
+            count_cells(this->structure.data(), outcome, begin, end, 1, histogram, cells);
+        else if (dim == DIM_FIELD)
+            count_cells(this->field.data(), outcome, begin, end, 1, histogram, cells);
+        else if (dim == DIM_BIT)
+            count_cells(this->bit.data(), outcome, begin, end, 1, histogram, cells);
+        else if (dim == DIM_TIME_BUCKET)
+            count_cells(this->time_ms.data(), outcome, begin, end, bucket_ms, histogram, cells);
+    });
+
+    std::vector<uint64_t> counts(cells, 0);
+    for (auto const& histogram : histograms) {
+        for (size_t lane = 0; lane < RESULT_HISTOGRAM_LANES; lane++) {
+            for (size_t c = 0; c < cells; c++)
+                counts[c] += histogram[lane * cells + c];
+        }
+    }
+    return counts;
+}
@@ -0,0 +1,74 @@
+#ifndef FREERTOS_FAULTINJECTOR_RESULTCOLUMNS_H
+#define FREERTOS_FAULTINJECTOR_RESULTCOLUMNS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SimulatorRun.h"
+
+// Magic number at the beginning of a columns file (8 bytes, format version included)
+#define RESULT_COLUMNS_MAGIC    "FICOLS02"
+
+// Outcomes counted (the values of SimulatorError)
+#define RESULT_OUTCOMES         (TIMING_VIOLATION + 1)
+
+// Rows turned into histogram cells at once (the cells of a block stay in the L1 cache)
+#define RESULT_BLOCK_ROWS       4096
+
+// Copies of a histogram updated in turn, so that consecutive equal cells don't wait for each other
+#define RESULT_HISTOGRAM_LANES  4
+
+enum ResultDimension {
+    DIM_STRUCTURE,
+    DIM_FIELD,
+    DIM_BIT,
+    DIM_TIME_BUCKET,
+    DIM_COUNT
+};
+
+/*
+* The results of one or more campaigns, one column per attribute of a trial:
+* the fault point (regenerated from the fault space of the journal) and the outcome.
+* Structures and fields are dictionary-encoded, so that every column is an array of small integers.
+* A breakdown counts the outcomes per group of a dimension in a single pass over two columns,
+* split among threads with a private histogram each.
+*/
+class ResultColumns {
+private:
+    std::vector<uint8_t> outcome;
+    std::vector<uint8_t> bit;
+    std::vector<uint32_t> structure;
+    std::vector<uint32_t> field;
+    std::vector<uint32_t> time_ms;
+
+    std::vector<std::string> structure_names;
+    std::vector<std::string> field_names;
+    std::map<std::string, uint32_t> structure_ids;
+    std::map<std::string, uint32_t> field_ids;
+
+    // Journaled trials without a fault (NOT_INJECTED): left out of the columns
+    uint64_t not_injected = 0;
+
+    uint32_t intern_structure(const std::string& name);
+    uint32_t intern_field(const std::string& name);
+
+public:
+    bool add_journal(const std::string& path, unsigned int threads);
+    bool load(const std::string& path);
+    void save(const std::string& path) const;
+
+    size_t size() const;
+    uint64_t get_not_injected() const;
+    size_t groups(ResultDimension dim, unsigned long bucket_ms) const;
+    std::string group_name(ResultDimension dim, size_t group, unsigned long bucket_ms) const;
+
+    // Counts of the outcome o of the group g in [g * RESULT_OUTCOMES + o]
+    std::vector<uint64_t> breakdown(ResultDimension dim, unsigned long bucket_ms, unsigned int threads) const;
+};
+
+const char* get_result_dimension_name(int dim);
+
+#endif //FREERTOS_FAULTINJECTOR_RESULTCOLUMNS_H
@@ -0,0 +1,212 @@
+/*
+* Offline analysis of campaign results.
+* Loads the journals of one or more campaigns (or the columns files saved by a previous analysis)
+* into columns, then breaks the outcomes down by structure, field, bit and time bucket.
+* Every rate comes with its Wilson score interval, which stays meaningful for the small groups
+* and for the rates close to 0 or 1 (e.g. the crashes of a field hit a few times).
+* The reports are written as CSV (one line per group and outcome) and as JSON.
+*
+* Usage: FreeRTOS_FaultInjector_Analysis [--bucket-ms ms] [--threads n] [--csv file] [--json file]
+*                                        [--save-columns file] input...
+*/
+
+#include <math.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "ResultColumns.h"
+#include "simulator_config.h"
+
+#define ANALYSIS_DEFAULT_BUCKET_MS  100
+#define ANALYSIS_DEFAULT_CSV        "campaign_analysis.csv"
+#define ANALYSIS_DEFAULT_JSON       "campaign_analysis.json"
+
+// z of the 95% confidence intervals
+#define ANALYSIS_WILSON_Z           1.96
+
+// Wilson score interval of count successes out of trials
+static void wilson_interval(uint64_t count, uint64_t trials, double& low, double& high) {
+    if (trials == 0) {
+        low = 0;
+        high = 1;
+        return;
+    }
+    double n = (double)trials;
+    double p = (double)count / n;
+    double z2 = ANALYSIS_WILSON_Z * ANALYSIS_WILSON_Z;
+    double denominator = 1 + z2 / n;
+    double center = (p + z2 / (2 * n)) / denominator;
+    double half = ANALYSIS_WILSON_Z * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / denominator;
+
+    low = std::max(0.0, center - half);
+    high = std::min(1.0, center + half);
+}
+
+static std::string json_escape(const std::string& s) {
+    std::string escaped;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static std::string csv_quote(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static double to_ms(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+int main(int argc, char** argv) {
+    unsigned long bucket_ms = ANALYSIS_DEFAULT_BUCKET_MS;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string csv_path = ANALYSIS_DEFAULT_CSV;
+    std::string json_path = ANALYSIS_DEFAULT_JSON;
+    std::string columns_path;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bucket-ms" && i + 1 < argc)
+            bucket_ms = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = (unsigned int)std::max(1, atoi(argv[++i]));
+        else if (arg == "--csv" && i + 1 < argc)
+            csv_path = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else if (arg == "--save-columns" && i + 1 < argc)
+            columns_path = argv[++i];
+        else
+            inputs.push_back(arg);
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--bucket-ms ms] [--threads n] [--csv file] [--json file] [--save-columns file] input..." << std::endl;
+        std::cerr << "An input is the journal of a campaign (output/" << JOURNAL_FILE_PREFIX << "*.bin) or a columns file." << std::endl;
+        exit(1);
+    }
+
+    // Load
+    ResultColumns columns;
+    auto begin = std::chrono::steady_clock::now();
+    for (auto const& input : inputs) {
+        if (!columns.load(input) && !columns.add_journal(input, threads)) {
+            std::cerr << input << " is neither the journal of a campaign nor a columns file." << std::endl;
+            exit(1);
+        }
+    }
+    auto load_time = std::chrono::steady_clock::now() - begin;
+
+    if (columns_path != "")
+        columns.save(columns_path);
+
+    // Breakdowns
+    begin = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint64_t>> counts(DIM_COUNT);
+    for (int dim = 0; dim < DIM_COUNT; dim++)
+        counts[dim] = columns.breakdown((ResultDimension)dim, bucket_ms, threads);
+    auto analysis_time = std::chrono::steady_clock::now() - begin;
+
+    std::cout << "Campaign analysis: " << columns.size() << " trials from " << inputs.size() << " input(s), " << threads << " thread(s)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    if (columns.get_not_injected() > 0)
+        std::cout << columns.get_not_injected() << " trials without a fault (not injected) left out" << std::endl;
+    std::cout << "Load: " << to_ms(load_time) << " ms, breakdowns: " << to_ms(analysis_time) << " ms" << std::endl;
+
+    std::ofstream csv(csv_path);
+    std::ofstream json(json_path);
+    if (!csv.is_open() || !json.is_open()) {
+        std::cerr << "Unable to open " << (csv.is_open() ? json_path : csv_path) << " for writing the analysis." << std::endl;
+        exit(1);
+    }
+
+    csv << std::fixed << std::setprecision(6);
+    json << std::fixed << std::setprecision(6);
+    csv << "dimension,group,trials,outcome,count,rate,ci_low,ci_high\n";
+    json << "{\n";
+    json << "  \"version\": \"" << PROJECT_VER << "\",\n";
+    json << "  \"trials\": " << columns.size() << ",\n";
+    json << "  \"not_injected\": " << columns.get_not_injected() << ",\n";
+    json << "  \"bucket_ms\": " << bucket_ms << ",\n";
+    json << "  \"confidence_z\": " << ANALYSIS_WILSON_Z << ",\n";
+    json << "  \"dimensions\": {";
+
+    for (int dim = 0; dim < DIM_COUNT; dim++) {
+        const char* dim_name = get_result_dimension_name(dim);
+        size_t groups = counts[dim].size() / RESULT_OUTCOMES;
+        bool first_group = true;
+
+        json << (dim == 0 ? "\n" : ",\n") << "    \"" << dim_name << "\": [";
+        for (size_t g = 0; g < groups; g++) {
+            const uint64_t* cell = &counts[dim][g * RESULT_OUTCOMES];
+            uint64_t trials = 0;
+            for (int se = 0; se < RESULT_OUTCOMES; se++)
+                trials += cell[se];
+            // e.g. the time buckets without a fault
+            if (trials == 0)
+                continue;
+
+            std::string group = columns.group_name((ResultDimension)dim, g, bucket_ms);
+            json << (first_group ? "\n" : ",\n") << "      { \"group\": \"" << json_escape(group) << "\", \"trials\": " << trials << ", \"outcomes\": {";
+            first_group = false;
+
+            for (int se = 0; se < RESULT_OUTCOMES; se++) {
+                double rate = (double)cell[se] / (double)trials;
+                double low, high;
+                wilson_interval(cell[se], trials, low, high);
+
+                csv << dim_name << "," << csv_quote(group) << "," << trials << "," << get_outcome_name(se) << "," << cell[se] << "," << rate << "," << low << "," << high << "\n";
+                json << " \"" << get_outcome_name(se) << "\": { \"count\": " << cell[se] << ", \"rate\": " << rate << ", \"ci_low\": " << low << ", \"ci_high\": " << high << " }"
+                    << (se + 1 < RESULT_OUTCOMES ? "," : " ");
+            }
+            json << "} }";
+        }
+        json << (first_group ? "]" : "\n    ]");
+    }
+    json << "\n  }\n";
+    json << "}\n";
+
+    // Summary per structure
+    const std::vector<uint64_t>& structures = counts[DIM_STRUCTURE];
+    std::cout << std::left << std::setw(40) << "Structure" << std::right << std::setw(10) << "Trials";
+    for (int se = 0; se < RESULT_OUTCOMES; se++)
+        std::cout << std::setw(18) << get_outcome_name(se);
+    std::cout << std::endl;
+    for (size_t g = 0; g < structures.size() / RESULT_OUTCOMES; g++) {
+        uint64_t trials = 0;
+        for (int se = 0; se < RESULT_OUTCOMES; se++)
+            trials += structures[g * RESULT_OUTCOMES + se];
+        std::cout << std::left << std::setw(40) << columns.group_name(DIM_STRUCTURE, g, bucket_ms) << std::right << std::setw(10) << trials;
+        for (int se = 0; se < RESULT_OUTCOMES; se++) {
+            double low, high;
+            wilson_interval(structures[g * RESULT_OUTCOMES + se], trials, low, high);
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(1) << (trials > 0 ? 100.0 * structures[g * RESULT_OUTCOMES + se] / trials : 0) << "% +-" << 100 * (high - low) / 2;
+            std::cout << std::setw(18) << ss.str();
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "Results written to " << csv_path << " and " << json_path << std::endl;
+    if (columns_path != "")
+        std::cout << "Columns saved to " << columns_path << std::endl;
+
+    return 0;
+}
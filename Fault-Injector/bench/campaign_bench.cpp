@@ -0,0 +1,190 @@
+/*
+* Campaign throughput benchmark.
+* Runs a golden run and a fixed-seed mini campaign with the same code path of the
+* FaultInjector, then reports the trials/sec and the time spent in each phase of a trial.
+* The results are written as JSON so that they can be compared between builds.
+*
+* Usage: FreeRTOS_FaultInjector_Bench [trials] [struct_id] [max_time_ms] [seed] [output_file] [workload] [trigger hook]
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <map>
+#include <chrono>
+#include <algorithm>
+
+#include "SimulatorRun.h"
+#include "FaultSpace.h"
+#include "Campaign.h"
+#include "PhaseProfile.h"
+#include "simulator_config.h"
+#include "FreeRTOSInterface.h"
+
+#include "loguru.hpp"
+#include "logger.h"
+
+#define SIMULATOR_EXE_NAME      "FreeRTOS_Simulator"
+
+#define BENCH_DEFAULT_TRIALS        5
+#define BENCH_DEFAULT_STRUCT_ID     0
+#define BENCH_DEFAULT_MAX_TIME_MS   1000
+#define BENCH_DEFAULT_SEED          42
+#define BENCH_DEFAULT_OUTPUT        "campaign_bench.json"
+
+static double to_ms(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+int main(int argc, char** argv) {
+    int trials = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_TRIALS;
+    int struct_id = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_STRUCT_ID;
+    unsigned long max_time_ms = argc > 3 ? std::stoul(argv[3]) : BENCH_DEFAULT_MAX_TIME_MS;
+    uint64_t seed = argc > 4 ? std::stoull(argv[4]) : BENCH_DEFAULT_SEED;
+    std::string output_path = argc > 5 ? argv[5] : BENCH_DEFAULT_OUTPUT;
+    std::string workload = argc > 6 ? argv[6] : "";
+    int trigger_hook = argc > 7 ? get_trigger_hook(argv[7]) : TRIGGER_HOOK_NONE;
+
+    std::string sim_path = SIMULATOR_EXE_NAME;
+    std::string log_name = "bench";
+
+    create_data_dirs();
+    log_init(loguru::Truncate, &log_name);
+    simulator_library.load(SIMULATOR_LIBRARY_PATH);
+
+    // Golden run
+    SimulatorRun golden_run;
+    std::map<int, size_t> sizes;
+
+    golden_run.init(sim_path, workload);
+    probe_exploded_sizes(golden_run, sizes);
+    MemorySampler golden_sampler(golden_run, MEMORY_SAMPLER_PERIOD_MS, false);
+    golden_run.start();
+    golden_sampler.start();
+    golden_run.wait();
+    golden_sampler.stop();
+    golden_sampler.get_max_exploded_sizes(sizes);
+    golden_run.save_output(nullptr);
+#if defined GOLDEN_REFERENCE_RUNS
+    run_reference_runs(sim_path, golden_run, GOLDEN_REFERENCE_RUNS, &sizes);
+    golden_run.get_tolerance().print_stats(true);
+#endif
+
+    if (sizes.find(struct_id) == sizes.end()) {
+        std::cerr << "Error: Data structure with id: " << struct_id << " not found." << std::endl;
+        exit(2);
+    }
+
+    // Fixed-seed fault space: the same build always injects the same faults
+    FaultSpace fault_space;
+    fault_space.add_structure(struct_id, sizes[struct_id]);
+    fault_space.init(max_time_ms, seed);
+    if ((uint64_t)trials > fault_space.size())
+        trials = (int)fault_space.size();
+
+    // Mini campaign
+    PhaseProfile campaign_profile;
+    std::map<int, int> outcomes;
+
+    // Outcomes per field of the fixed part of the structure (e.g. to see which fields are vulnerable)
+    const std::vector<DataStructure>& structs = golden_run.get_data_structures();
+    auto target = std::find_if(structs.begin(), structs.end(), [struct_id](const DataStructure& ds) { return ds.get_id() == struct_id; });
+    std::map<std::string, std::map<int, int>> field_outcomes;
+    std::map<std::string, int> field_kinds;
+
+    // Reused from a trial to the next one, as in the campaigns
+    SimulatorRun sr;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < trials; i++) {
+        SimulatorError se = run_injection_trial(sim_path, golden_run, sr, fault_space.at(i), "", false, trigger_hook);
+        campaign_profile.add(sr.get_profile());
+        outcomes[se]++;
+
+        size_t byte = fault_space.at(i).byte % sizes[struct_id];
+        char field_name[128];
+        int field_kind;
+        if (se != NOT_INJECTED && byte < target->get_fixed_size() && target->get_type() != TYPE_STATIC_STACK && target->get_type() != TYPE_TASK_STACK && target->get_type() != TYPE_HEAP_ARENA &&
+            get_struct_field(target->get_type(), byte, field_name, sizeof(field_name), &field_kind)) {
+            field_outcomes[field_name][se]++;
+            field_kinds[field_name] = field_kind;
+        }
+    }
+    auto wall = std::chrono::steady_clock::now() - begin;
+
+    double wall_s = std::chrono::duration<double>(wall).count();
+    double trials_per_sec = wall_s > 0 ? trials / wall_s : 0;
+    double profiled_ms = to_ms(campaign_profile.total());
+
+    // Human readable summary
+    std::cout << "Campaign benchmark: " << trials << " trials in " << std::fixed << std::setprecision(3) << wall_s << " s (" << trials_per_sec << " trials/sec)" << std::endl;
+    std::cout << std::left << std::setw(24) << "Phase" << std::right << std::setw(14) << "Mean (ms)" << std::setw(10) << "Share" << std::endl;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double total_ms = to_ms(campaign_profile.get((TrialPhase)p));
+        std::cout << std::left << std::setw(24) << get_trial_phase_name(p) << std::right << std::setw(14) << (trials > 0 ? total_ms / trials : 0)
+            << std::setw(9) << (profiled_ms > 0 ? 100 * total_ms / profiled_ms : 0) << "%" << std::endl;
+    }
+    if (!field_outcomes.empty()) {
+        std::cout << std::left << std::setw(48) << "Field" << std::setw(12) << "Kind" << "Outcomes" << std::endl;
+        for (auto& f : field_outcomes) {
+            std::cout << std::left << std::setw(48) << f.first << std::setw(12) << get_field_kind_name(field_kinds[f.first]);
+            for (auto const& o : f.second)
+                std::cout << get_outcome_name(o.first) << "=" << o.second << " ";
+            std::cout << std::endl;
+        }
+    }
+
+    // Machine readable results
+    std::ofstream out(output_path);
+    if (!out.is_open()) {
+        std::cerr << "Unable to open " << output_path << " for writing the benchmark results." << std::endl;
+        exit(1);
+    }
+
+    out << std::fixed << std::setprecision(6);
+    out << "{\n";
+    out << "  \"version\": \"" << PROJECT_VER << "\",\n";
+    out << "  \"trials\": " << trials << ",\n";
+    out << "  \"struct_id\": " << struct_id << ",\n";
+    out << "  \"exploded_size\": " << sizes[struct_id] << ",\n";
+    out << "  \"max_time_ms\": " << max_time_ms << ",\n";
+    out << "  \"seed\": " << seed << ",\n";
+    out << "  \"trigger\": \"" << get_trigger_hook_name(trigger_hook) << "\",\n";
+    out << "  \"golden_duration_ms\": " << to_ms(golden_run.duration()) << ",\n";
+    out << "  \"reference_runs\": " << golden_run.get_tolerance().get_reference_runs() << ",\n";
+    out << "  \"wall_s\": " << wall_s << ",\n";
+    out << "  \"trials_per_sec\": " << trials_per_sec << ",\n";
+    out << "  \"phases\": {\n";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double total_ms = to_ms(campaign_profile.get((TrialPhase)p));
+        out << "    \"" << get_trial_phase_name(p) << "\": { \"total_ms\": " << total_ms
+            << ", \"mean_ms\": " << (trials > 0 ? total_ms / trials : 0)
+            << ", \"share\": " << (profiled_ms > 0 ? total_ms / profiled_ms : 0) << " }"
+            << (p + 1 < PHASE_COUNT ? "," : "") << "\n";
+    }
+    out << "  },\n";
+    out << "  \"outcomes\": {";
+    for (int se = MASKED; se <= NOT_INJECTED; se++) {
+        out << " \"" << get_outcome_name(se) << "\": " << outcomes[se] << (se < NOT_INJECTED ? "," : " ");
+    }
+    out << "},\n";
+    out << "  \"fields\": {";
+    for (auto it = field_outcomes.begin(); it != field_outcomes.end(); ++it) {
+        out << (it == field_outcomes.begin() ? "\n" : ",\n");
+        out << "    \"" << it->first << "\": { \"kind\": \"" << get_field_kind_name(field_kinds[it->first]) << "\", \"outcomes\": {";
+        for (int se = MASKED; se <= TIMING_VIOLATION; se++) {
+            out << " \"" << get_outcome_name(se) << "\": " << it->second[se] << (se < TIMING_VIOLATION ? "," : " ");
+        }
+        out << "} }";
+    }
+    out << (field_outcomes.empty() ? "}\n" : "\n  }\n");
+    out << "}\n";
+    out.close();
+
+    std::cout << "Results written to " << output_path << std::endl;
+
+    remove_tmp();
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "logger.h"
+#include "Campaign.h"
 #include <ctime>
 #include <iostream>
 #include <fstream>
@@ -56,15 +57,35 @@ void log_injection_trial(SimulatorRun& golden, SimulatorRun& sr, Injection& inj,
         break;
     case DELAY:
         RAW_LOG_F(INFO, "Simulator error:\t Delay");
-        RAW_LOG_F(INFO, "The injected FreeRTOS simulator has produced the following output with a delay of %d operations:", sr.get_delay_amount());
+        RAW_LOG_F(INFO, "The injected FreeRTOS simulator has produced the following output with a delay of %d operations (%lld ticks):", sr.get_delay_amount(), sr.get_delay_ticks());
         RAW_LOG_F(INFO, "%s", sr.get_delayed_str().c_str());
         break;
     case HANG:
         RAW_LOG_F(INFO, "Simulator error:\t Hang");
 
-        ss << std::chrono::duration_cast<std::chrono::seconds>(golden.duration() * DEADLOCK_TIME_FACTOR).count();
-        
-        RAW_LOG_F(INFO, "Simulator forcely killed after %s seconds (probable deadlock/spinlock)", ss.str().c_str());
+        ss << std::chrono::duration_cast<std::chrono::milliseconds>(sr.duration()).count();
+
+        RAW_LOG_F(INFO, "Simulator forcely killed after %s ms (probable deadlock/spinlock)", ss.str().c_str());
+        RAW_LOG_F(INFO, "Check cycles completed: %lu (hang timeout without progress: %lld ms)", sr.get_progress_cycles(),
+            (long long)std::chrono::duration_cast<std::chrono::milliseconds>(hang_timeout(golden)).count());
+        break;
+    case TIMING_VIOLATION:
+        RAW_LOG_F(INFO, "Simulator error:\t Timing violation");
+        RAW_LOG_F(INFO, "Worst lateness: %lu ticks after the release, for the %s (at most %lu ticks tolerated)", sr.get_timing_violation_lateness(),
+            sr.get_timing_violation_key().c_str(), sr.get_timing_violation_bound());
+        {
+            auto deadlines = sr.get_deadline_stats();
+            auto it = deadlines.find(sr.get_timing_violation_key());
+            if (it != deadlines.end())
+                RAW_LOG_F(INFO, "Late activations: %lu / %lu", it->second.misses, it->second.activations);
+        }
+        break;
+    case NOT_INJECTED:
+        RAW_LOG_F(INFO, "Simulator error:\t Not injected");
+        if (inj.is_trigger_armed())
+            RAW_LOG_F(INFO, "The run didn't reach the occurrence of the trigger: the trial is not counted in the outcomes");
+        else
+            RAW_LOG_F(INFO, "The fault point has no target in this run (e.g. a byte beyond the current size): the trial is not counted in the outcomes");
         break;
     case CRASH:
         RAW_LOG_F(INFO, "Simulator error:\t Crash");
@@ -76,6 +97,32 @@ void log_injection_trial(SimulatorRun& golden, SimulatorRun& sr, Injection& inj,
         break;
     }
     RAW_LOG_F(INFO, "");
+
+    if (sr.stopped_early()) {
+        RAW_LOG_F(INFO, "State digest equal to the golden one at check cycle %zu: run stopped early", sr.get_state_digests().size());
+        RAW_LOG_F(INFO, "");
+    }
+
+    // Latency of the fault, in kernel ticks (only the runs which exited normally have an output)
+    if (se != HANG && se != CRASH && se != NOT_INJECTED) {
+        if (sr.get_first_divergence_line() != -1) {
+            RAW_LOG_F(INFO, "First divergence from golden after the injection at output line %lld, tick %lu", sr.get_first_divergence_line(), sr.get_first_divergence_tick());
+            if (inj.has_injection_tick())
+                RAW_LOG_F(INFO, "Fault-to-first-divergence latency: %lld ticks", (long long)sr.get_first_divergence_tick() - (long long)inj.get_injection_tick());
+        }
+        RAW_LOG_F(INFO, "Max per-line delay w.r.t. golden: %lld ticks", sr.get_max_line_delay_ticks());
+        RAW_LOG_F(INFO, "");
+    }
+
+    // Only the runs which exited normally have written their task stats
+    if (se != HANG && se != CRASH && se != NOT_INJECTED) {
+        sr.print_task_stats(&golden, true);
+    }
+
+    if (se != MASKED && se != NOT_INJECTED && sr.get_trace_path() != "" && fs::exists(sr.get_trace_path())) {
+        RAW_LOG_F(INFO, "Kernel trace: %s", sr.get_trace_path().c_str());
+        RAW_LOG_F(INFO, "");
+    }
 }
 
 void log_join(std::string fname) {
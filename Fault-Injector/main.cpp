@@ -4,9 +4,15 @@
 #include <time.h>
 #include <algorithm>
 #include <cstdlib>
+#include <map>
 
 #include "SimulatorRun.h"
 #include "Injection.h"
+#include "FaultSpace.h"
+#include "Campaign.h"
+#include "Coordinator.h"
+#include "Worker.h"
+#include "CampaignJournal.h"
 #include "simulator_config.h"
 #include "memory_logger.h"
 
@@ -17,6 +23,9 @@
 
 #define SIMULATOR_EXE_NAME      "FreeRTOS_Simulator"
 
+// A parallel instance exits with this code plus the outcome of its trial
+#define TRIAL_EXIT_CODE_BASE    64
+
 std::string sim_exe_name = SIMULATOR_EXE_NAME;
 std::string sim_path = sim_exe_name;
 
@@ -26,30 +35,85 @@ typedef struct {
     long long max_time_ms;
     bool parallelize;
     std::string error_pattern;
+    int sample_every;
+    std::string workload;
+    uint64_t fault_space_key;
+    unsigned short coordinator_port;
+    std::string resume_path;
+    int trigger_hook;
 } InjectConf;
 
 void menu(InjectConf &conf);
 
+void menu_parallelize(InjectConf& conf);
+
 SimulatorRun golden_run;
 std::error_code golden_run_ec;
 
-void injection(InjectConf& conf);
+// The run of the injection trials of this process (reused from a trial to the next one)
+SimulatorRun injected_run;
+
+// PID of the golden run whose output files are used (the master's golden run can be the one of a resumed campaign)
+int golden_run_pid;
+
+// Exploded size of every data structure, read from the golden run before starting it
+std::map<int, size_t> golden_exploded_sizes;
+
+// Fault space of the campaign (sampled without replacement)
+FaultSpace fault_space;
+
+// Journal of the campaign, to resume it if the master dies
+CampaignJournal journal;
+
+CampaignSpec get_campaign_spec(const InjectConf& conf);
+
+void load_campaign_spec(InjectConf& conf, const CampaignSpec& spec);
+
+bool golden_output_exists(int pid);
+
+void init_fault_space(InjectConf& conf);
+
+SimulatorError injection(InjectConf& conf, FaultPoint fp, int trial);
 
 void sequential_injections(InjectConf &conf);
 
 void parallel_injections(InjectConf& conf, char* exe_name);
 
+void coordinate_injections(InjectConf& conf);
+
 int main(int argc, char ** argv)
 {
     InjectConf conf;
 
     create_data_dirs();
 
+    // Fork the simulator runs from its shared library build, when available, instead of executing it
+    simulator_library.load(SIMULATOR_LIBRARY_PATH);
+
     // Check if this process has been created from another process (parallelization)
-    int golden_run_pid;
+    int exit_code = 0;
     std::string curr_pid = std::to_string(boost::interprocess::ipcdetail::get_current_process_id());
 
-    if (argc > 1) {
+    // Master usage: FreeRTOS_FaultInjector [--workload <manifest>] [--coordinator <port>] [--resume <journal>] [--trigger <hook>]
+    // Worker usage: FreeRTOS_FaultInjector --worker <coordinator host> <port>
+    if (argc > 1 && std::string(argv[1]) == WORKER_ARG) {
+        // Worker of a campaign served by a coordinator
+        if (argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " " << WORKER_ARG << " <coordinator host> <port>" << std::endl;
+            exit(1);
+        }
+
+        std::string log_name = "worker_" + curr_pid;
+        log_init(loguru::Truncate, &log_name);
+
+        Worker worker(argv[2], (unsigned short)atoi(argv[3]));
+        worker.run(sim_path);
+
+        // Other workers can be running in the same directory: tmp is left to them
+        return 0;
+    }
+    else if (argc > 1 && std::string(argv[1]) != WORKLOAD_ARG && std::string(argv[1]) != COORDINATOR_ARG && std::string(argv[1]) != RESUME_ARG &&
+        std::string(argv[1]) != TRIGGER_ARG) {
         // Parallel instance
 
         unsigned long golden_run_dur_ms;
@@ -59,66 +123,193 @@ int main(int argc, char ** argv)
         ss >> golden_run_dur_ms;
         golden_run.load_duration(golden_run_dur_ms);
 
-        int rand_seed = atoi(argv[3]);
-        srand((unsigned)rand_seed);
+        conf.struct_id = atoi(argv[3]);
+        conf.inject_n = atoi(argv[4]);
 
-        conf.struct_id = atoi(argv[4]);
-        conf.inject_n = atoi(argv[5]);
-        conf.max_time_ms = atoi(argv[6]);
-        if (argc > 7)
-            conf.error_pattern = atoi(argv[7]);
+        // The fault point has been drawn by the master from the campaign fault space
+        FaultPoint fp;
+        fp.struct_id = conf.struct_id;
+        fp.byte = std::stoull(argv[5]);
+        fp.bit = (unsigned short)atoi(argv[6]);
+        fp.time_ms = std::stoul(argv[7]);
+
+        conf.sample_every = atoi(argv[8]);
+
+        conf.workload = argv[9];
+        golden_run.load_workload(conf.workload);
+
+        conf.trigger_hook = atoi(argv[10]);
+
+        if (argc > 11)
+            conf.error_pattern = argv[11];
         else
             conf.error_pattern = "";
 
         // Open temp log
         log_init(loguru::Truncate, &curr_pid);
 
-        // Load the golden run output
+        // Load the golden run output, and its tolerance model if the master has learnt one
         golden_run.save_output(&golden_run_pid);
+        golden_run.get_tolerance().load(golden_run_pid);
 
-        // Start a simulation and inject
-        injection(conf);
+        // Start a simulation and inject (the outcome is told to the master with the exit code)
+        exit_code = TRIAL_EXIT_CODE_BASE + injection(conf, fp, conf.inject_n);
     }
     else {
         // Master instance
         srand((unsigned)time(NULL));
 
+        conf.workload = "";
+        conf.coordinator_port = 0;
+        conf.resume_path = "";
+        conf.trigger_hook = TRIGGER_HOOK_NONE;
+        for (int i = 1; i < argc; i += 2) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc || (arg != WORKLOAD_ARG && arg != COORDINATOR_ARG && arg != RESUME_ARG && arg != TRIGGER_ARG) ||
+                (arg == TRIGGER_ARG && get_trigger_hook(argv[i + 1]) == TRIGGER_HOOK_NONE)) {
+                std::cerr << "Usage: " << argv[0] << " [" << WORKLOAD_ARG << " <manifest>] [" << COORDINATOR_ARG << " <port>] [" << RESUME_ARG << " <journal>] [" << TRIGGER_ARG << " <hook>]" << std::endl;
+                std::cerr << "       " << argv[0] << " " << WORKER_ARG << " <coordinator host> <port>" << std::endl;
+                std::cerr << "Hooks:";
+                for (int hook = TRIGGER_HOOK_NONE + 1; hook < TRIGGER_HOOK_COUNT; hook++)
+                    std::cerr << " " << get_trigger_hook_name(hook);
+                std::cerr << std::endl;
+                exit(1);
+            }
+            if (arg == WORKLOAD_ARG)
+                conf.workload = argv[i + 1];
+            else if (arg == COORDINATOR_ARG)
+                conf.coordinator_port = (unsigned short)atoi(argv[i + 1]);
+            else if (arg == TRIGGER_ARG)
+                conf.trigger_hook = get_trigger_hook(argv[i + 1]);
+            else
+                conf.resume_path = argv[i + 1];
+        }
+
         std::cout << "######### FreeRTOS FaultInjector v" << PROJECT_VER << " #########" << std::endl;
         std::cout << std::endl;
 
         log_init(loguru::Truncate, nullptr);
 
-        // Start a simulator and save the golden execution
-        LOG_F(INFO, "Executing the simulator and saving the golden execution...");
+        if (simulator_library.is_loaded())
+            LOG_F(INFO, "Simulator runs forked from %s", SIMULATOR_LIBRARY_PATH);
 
-        golden_run.init(sim_path);
-        golden_run.start();
-        golden_run_ec = golden_run.wait();
-        golden_run.save_output(nullptr);
-        RAW_LOG_F(INFO, "Golden run stats:");
-        golden_run.print_stats(true);
+        // A resumed campaign takes its configuration, golden run and finished trials from its journal
+        bool golden_loaded = false;
+        if (conf.resume_path != "") {
+            if (!journal.open(conf.resume_path) || !journal.has_config()) {
+                std::cerr << conf.resume_path << " is not the journal of a campaign." << std::endl;
+                exit(1);
+            }
+            load_campaign_spec(conf, journal.get_config());
+            LOG_F(INFO, "Resuming the campaign of %s: %zu / %d trials finished", conf.resume_path.c_str(), journal.get_trials().size(), conf.inject_n);
+
+            if (journal.has_golden() && golden_output_exists((int)journal.get_golden_pid())) {
+                golden_run_pid = (int)journal.get_golden_pid();
+                golden_run.load_workload(conf.workload);
+                golden_run.load_duration(journal.get_golden_duration_ms());
+                golden_run.save_output(&golden_run_pid);
+                golden_run.get_tolerance().load(golden_run_pid);
+                golden_loaded = true;
+                LOG_F(INFO, "Golden execution (PID %d) loaded from its output", golden_run_pid);
+            }
+        }
 
-        // Display user menu
-        menu(conf);
+        // Sizes of the data structures before the scheduler starts (a fault space can't be smaller)
+        std::map<int, size_t> probed_sizes;
+
+        if (!golden_loaded) {
+            // Start a simulator and save the golden execution
+            LOG_F(INFO, "Executing the simulator and saving the golden execution...");
+
+            if (conf.workload != "")
+                LOG_F(INFO, "Workload: %s", conf.workload.c_str());
+            golden_run.init(sim_path, conf.workload);
+            probe_exploded_sizes(golden_run, probed_sizes);
+            golden_exploded_sizes = probed_sizes;
+            MemorySampler golden_sampler(golden_run, MEMORY_SAMPLER_PERIOD_MS);
+            golden_run.start();
+            golden_sampler.start();
+            golden_run_ec = golden_run.wait();
+            golden_sampler.stop();
+            golden_sampler.get_max_exploded_sizes(golden_exploded_sizes);
+            golden_run.save_output(nullptr);
+            golden_run_pid = (int)golden_run.get_pid();
+            RAW_LOG_F(INFO, "Golden run stats:");
+            golden_run.print_stats(true);
+            golden_run.print_task_stats(nullptr, true);
+            golden_sampler.print_stats(true);
+
+#if defined GOLDEN_REFERENCE_RUNS
+            // Learn which differences from the golden execution are just the simulator non-determinism
+            // (the workers of a coordinator compare with their own golden run)
+            if (conf.coordinator_port == 0) {
+                LOG_F(INFO, "Executing %d concurrent reference runs of the golden execution...", GOLDEN_REFERENCE_RUNS);
+                run_reference_runs(sim_path, golden_run, GOLDEN_REFERENCE_RUNS, &golden_exploded_sizes);
+                golden_run.get_tolerance().save(golden_run.get_pid());
+                golden_run.get_tolerance().print_stats(true);
+            }
+#endif
+        }
+
+        if (conf.resume_path == "") {
+            // Display user menu
+            menu(conf);
+            conf.fault_space_key = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+        }
+        else {
+            // The fault space of a resumed campaign is the one of its journal
+            if (!golden_loaded && probed_sizes[conf.struct_id] > journal.get_config().exploded_size) {
+                std::cerr << "The data structure " << conf.struct_id << " doesn't have the size it has in the journal (a different build?)" << std::endl;
+                exit(1);
+            }
+            golden_exploded_sizes[conf.struct_id] = journal.get_config().exploded_size;
+            if (conf.coordinator_port == 0)
+                menu_parallelize(conf);
+        }
+
+        // Build the fault space of the campaign
+        init_fault_space(conf);
+
+        if (conf.trigger_hook != TRIGGER_HOOK_NONE) {
+            uint64_t count = golden_run.get_trigger_count(conf.trigger_hook);
+            if (count == 0)
+                LOG_F(WARNING, "The hook %s never occurred in the golden run: the faults are injected at their time instead", get_trigger_hook_name(conf.trigger_hook));
+            else
+                LOG_F(INFO, "Injection trigger: hook %s (%llu occurrences in the golden run)", get_trigger_hook_name(conf.trigger_hook), (unsigned long long)count);
+        }
+
+        // Journal the campaign from now on
+        if (!journal.is_open()) {
+            std::string s1 = JOURNAL_FILE_PREFIX;
+            journal.create("output/" + s1 + curr_pid + ".bin");
+            journal.write_config(get_campaign_spec(conf));
+            const DataStructure& target = golden_run.get_ds_by_id(conf.struct_id);
+            journal.write_structure({ target.get_id(), target.get_type(), (uint64_t)target.get_fixed_size(), target.get_name() });
+        }
+        if (!golden_loaded)
+            journal.write_golden(golden_run_pid, (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(golden_run.duration()).count());
+        LOG_F(INFO, "Campaign journal: %s (resume with %s %s)", journal.get_path().c_str(), RESUME_ARG, journal.get_path().c_str());
 
         // Perform injections
         LOG_F(INFO, "-- Injections start --");
-        if (!conf.parallelize)
+        if (conf.coordinator_port != 0)
+            coordinate_injections(conf);
+        else if (!conf.parallelize)
             sequential_injections(conf);
         else
             parallel_injections(conf, argv[0]);
 
+        journal.close();
     }
 
     remove_tmp();
 
-    return 0;
+    return exit_code;
 }
 
 void menu(InjectConf &conf) {
     using namespace std;
     int op;
-    string parallelize_str;
     string pattern_error_str;
 
     while (true) {
@@ -178,23 +369,10 @@ void menu(InjectConf &conf) {
             }
         }
 
-        while (true) {
-            cout << "Conf3 -) Do you want to parallelize the injections? [Y/N] ";
-            cin >> parallelize_str;
-            std::for_each(parallelize_str.begin(), parallelize_str.end(), [](char& c) {
-                c = ::toupper(c);
-                });
-            if (parallelize_str == "Y") {
-                conf.parallelize = true;
-                break;
-            }
-            else if (parallelize_str == "N") {
-                conf.parallelize = false;
-                break;
-            }
-            else
-                cerr << "Invalid option. Try again." << endl;
-        }
+        // The trials of a coordinator run on its workers
+        conf.parallelize = false;
+        if (conf.coordinator_port == 0)
+            menu_parallelize(conf);
 
         while (true) {
             cout << "Conf4 -) Indicate the maximum time (in milliseconds) in which the random injection has to be performed: ";
@@ -227,82 +405,149 @@ void menu(InjectConf &conf) {
 
         }
 
+        while (true) {
+            cout << "Conf6 -) Sample the data structures of one injected run every how many? (0 = none) ";
+            cin >> conf.sample_every;
+            if (conf.sample_every >= 0) {
+                break;
+            }
+            else {
+                cerr << "The number can't be negative. Try again." << endl;
+            }
+        }
+
         cout << "-- Configuration completed --" << endl;
         cout << endl;
         return;
     }
 }
 
-void injection(InjectConf& conf) {
-    SimulatorRun sr;
-    std::error_code ec;
-    SimulatorError se;
+void menu_parallelize(InjectConf& conf) {
+    using namespace std;
+    string parallelize_str;
 
-    // Spawn a simulator instance to be injected and load its data structures
-    sr.init(sim_path);
+    while (true) {
+        cout << "Conf3 -) Do you want to parallelize the injections? [Y/N] ";
+        cin >> parallelize_str;
+        std::for_each(parallelize_str.begin(), parallelize_str.end(), [](char& c) {
+            c = ::toupper(c);
+            });
+        if (parallelize_str == "Y") {
+            conf.parallelize = true;
+            break;
+        }
+        else if (parallelize_str == "N") {
+            conf.parallelize = false;
+            break;
+        }
+        else
+            cerr << "Invalid option. Try again." << endl;
+    }
+}
 
-    // Retrieve the data structure to be injected
-    DataStructure ds = sr.get_ds_by_id(conf.struct_id);
-    Injection inj(&sr, ds, conf.max_time_ms);
+CampaignSpec get_campaign_spec(const InjectConf& conf) {
+    CampaignSpec spec;
 
-    // Signal to the simulator instance that it can start the scheduler
-    sr.start();
-    inj.init();
-    inj.inject(sr.get_begin_time());
-    inj.close();
+    spec.struct_id = conf.struct_id;
+    spec.exploded_size = golden_exploded_sizes[conf.struct_id];
+    spec.max_time_ms = (unsigned long)conf.max_time_ms;
+    spec.key = conf.fault_space_key;
+    spec.trials = conf.inject_n;
+    spec.sample_every = conf.sample_every;
+    spec.workload = conf.workload;
+    spec.error_pattern = conf.error_pattern;
+    spec.trigger_hook = conf.trigger_hook;
 
-    // Wait for the simulator to finish and log
-    if (sr.wait_for(golden_run.duration() * DEADLOCK_TIME_FACTOR, ec)) {
-        // The child exited and the timer has not expired yet
-        int native_exit_code = sr.get_native_exit_code();
+    return spec;
+}
 
-        if (native_exit_code) {
-            se = CRASH;
-        }
-        else {
-            // Child process exited with code 0 and everything should be ok
-            sr.save_output(nullptr);
+void load_campaign_spec(InjectConf& conf, const CampaignSpec& spec) {
+    conf.struct_id = spec.struct_id;
+    conf.max_time_ms = spec.max_time_ms;
+    conf.fault_space_key = spec.key;
+    conf.inject_n = (int)spec.trials;
+    conf.sample_every = spec.sample_every;
+    conf.workload = spec.workload;
+    conf.error_pattern = spec.error_pattern;
+    conf.trigger_hook = spec.trigger_hook;
+    conf.parallelize = false;
+}
 
-            // Perform comparison
-            se = sr.compare_with_golden(golden_run, conf.error_pattern);
-        }
-    }
-    else {
-        // The child didn't exit and the timer has expired (possible deadlock)
-        sr.terminate();
-        se = HANG;
+bool golden_output_exists(int pid) {
+    std::string output_f_pref = OUTPUT_FILE_PREFIX;
+    std::ifstream output_file("output/" + output_f_pref + std::to_string(pid) + ".txt");
+    return output_file.is_open();
+}
+
+void init_fault_space(InjectConf& conf) {
+    fault_space.add_structure(conf.struct_id, golden_exploded_sizes[conf.struct_id]);
+    fault_space.init((unsigned long)conf.max_time_ms, conf.fault_space_key);
+
+    LOG_F(INFO, "Fault space: %llu points (key %llu)", (unsigned long long)fault_space.size(), (unsigned long long)conf.fault_space_key);
+
+    // An exhaustive campaign can't have more trials than points
+    if ((uint64_t)conf.inject_n > fault_space.size()) {
+        LOG_F(WARNING, "Only %llu distinct faults exist, the campaign is reduced to an exhaustive one.", (unsigned long long)fault_space.size());
+        conf.inject_n = (int)fault_space.size();
     }
+}
+
+SimulatorError injection(InjectConf& conf, FaultPoint fp, int trial) {
+    bool sample_memory = conf.sample_every > 0 && trial % conf.sample_every == 0;
 
-    // Log injection results
-    log_injection_trial(golden_run, sr, inj, ec, se, conf.error_pattern);
+    return run_injection_trial(sim_path, golden_run, injected_run, fp, conf.error_pattern, sample_memory, conf.trigger_hook);
 }
 
 void sequential_injections(InjectConf& conf) {
     for (int i = 0; i < conf.inject_n; i++) {
+        // Finished before the campaign was resumed
+        if (journal.is_finished(i))
+            continue;
+
         LOG_F(INFO, "Injection Try #%d / %d ...", i + 1, conf.inject_n);
 
-        injection(conf);
+        auto begin = std::chrono::steady_clock::now();
+        SimulatorError se = injection(conf, fault_space.at(i), i);
+        auto duration = std::chrono::steady_clock::now() - begin;
+
+        TrialResult result = { (uint64_t)i, (int32_t)se, 0, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() };
+        journal.write_trial(result);
 
         LOG_F(INFO, "Injection finished.");
         LOG_F(INFO, "----------------------\n");
     }
 }
 
+void coordinate_injections(InjectConf& conf) {
+    std::cout << "Serving " << conf.inject_n << " injection trials to the workers on port " << conf.coordinator_port << ".." << std::endl;
+    Coordinator coordinator(get_campaign_spec(conf), conf.coordinator_port, &journal);
+    coordinator.run();
+    coordinator.print_stats(true);
+}
+
 void parallel_injections(InjectConf& conf, char *exe_name) {
     std::vector<bp::child> childs(conf.inject_n);
+    std::vector<std::chrono::steady_clock::time_point> begin_times(conf.inject_n);
     std::cout << "Performing " << conf.inject_n << " parallel injection trials.." << std::endl;
-    // Start #Injections fault injector processes (in parallel mode)
+    // Start #Injections fault injector processes (in parallel mode), except the ones finished before a resume
     for (int i = 0; i < conf.inject_n; i++) {
-        int rand_seed = rand() % RAND_MAX;
+        if (journal.is_finished(i))
+            continue;
+        begin_times[i] = std::chrono::steady_clock::now();
+        FaultPoint fp = fault_space.at(i);
         if (conf.error_pattern == "") {
             bp::child c(
                 exe_name,
-                std::to_string(golden_run.get_pid()),
+                std::to_string(golden_run_pid),
                 std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(golden_run.duration()).count()),
-                std::to_string(rand_seed),
                 std::to_string(conf.struct_id),
                 std::to_string(i),
-                std::to_string(conf.max_time_ms),
+                std::to_string(fp.byte),
+                std::to_string(fp.bit),
+                std::to_string(fp.time_ms),
+                std::to_string(conf.sample_every),
+                conf.workload,
+                std::to_string(conf.trigger_hook),
                 bp::std_out > bp::null,
                 bp::std_err > bp::null
             );
@@ -311,12 +556,16 @@ void parallel_injections(InjectConf& conf, char *exe_name) {
         else {
             bp::child c(
                 exe_name,
-                std::to_string(golden_run.get_pid()),
+                std::to_string(golden_run_pid),
                 std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(golden_run.duration()).count()),
-                std::to_string(rand_seed),
                 std::to_string(conf.struct_id),
                 std::to_string(i),
-                std::to_string(conf.max_time_ms),
+                std::to_string(fp.byte),
+                std::to_string(fp.bit),
+                std::to_string(fp.time_ms),
+                std::to_string(conf.sample_every),
+                conf.workload,
+                std::to_string(conf.trigger_hook),
                 conf.error_pattern,
                 bp::std_out > bp::null,
                 bp::std_err > bp::null
@@ -327,8 +576,18 @@ void parallel_injections(InjectConf& conf, char *exe_name) {
 
     // Wait for the completion of all the fault injectors and join their output to the main logging file
     for (int i = 0; i < conf.inject_n; i++) {
+        if (!childs[i].valid())
+            continue;
         childs[i].wait();
 
+        // An instance which didn't exit with an outcome is run again if the campaign is resumed
+        int outcome = childs[i].exit_code() - TRIAL_EXIT_CODE_BASE;
+        if (outcome >= MASKED && outcome <= NOT_INJECTED) {
+            auto duration = std::chrono::steady_clock::now() - begin_times[i];
+            TrialResult result = { (uint64_t)i, (int32_t)outcome, 0, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() };
+            journal.write_trial(result);
+        }
+
         LOG_F(INFO, "Injection Try #%d / %d ...", i + 1, conf.inject_n);
         log_join(std::to_string(childs[i].id()));
         LOG_F(INFO, "Injection finished.");
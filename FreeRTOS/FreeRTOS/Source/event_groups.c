@@ -781,6 +781,28 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits,
         return sizeof(EventGroup_t);
     }
 
+    #if ( configEXPORT_FIELD_LAYOUT == 1 )
+
+        static const FieldLayout xEventGroupFields[] =
+        {
+            FIELD_LAYOUT( EventGroup_t, uxEventBits, FIELD_KIND_FLAG ),
+            FIELD_LAYOUT( EventGroup_t, xTasksWaitingForBits, FIELD_KIND_LIST ),
+            #if ( configUSE_TRACE_FACILITY == 1 )
+                FIELD_LAYOUT( EventGroup_t, uxEventGroupNumber, FIELD_KIND_VALUE ),
+            #endif
+            #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+                FIELD_LAYOUT( EventGroup_t, ucStaticallyAllocated, FIELD_KIND_FLAG ),
+            #endif
+        };
+
+        const FieldLayout * getEventGroup_Fields( size_t * pxCount )
+        {
+            *pxCount = FIELD_LAYOUT_COUNT( xEventGroupFields );
+            return xEventGroupFields;
+        }
+
+    #endif /* configEXPORT_FIELD_LAYOUT */
+
     size_t getEventGroup_CurrentExplodedSize(EventGroupHandle_t xHandle)
     {
         EventGroup_t* o = (EventGroup_t*)xHandle;
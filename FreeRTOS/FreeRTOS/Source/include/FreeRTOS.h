@@ -564,6 +564,10 @@
     #define traceTASK_DELAY_UNTIL( x )
 #endif
 
+#ifndef traceTASK_DELAY_UNTIL_RELEASED
+    #define traceTASK_DELAY_UNTIL_RELEASED( xTimeToWake, xTimeIncrement )
+#endif
+
 #ifndef traceTASK_DELAY
     #define traceTASK_DELAY()
 #endif
@@ -604,6 +608,10 @@
     #define traceTIMER_EXPIRED( pxTimer )
 #endif
 
+#ifndef traceTIMER_RELEASED
+    #define traceTIMER_RELEASED( pxTimer, xExpireTime, xTimeNow )
+#endif
+
 #ifndef traceTIMER_COMMAND_RECEIVED
     #define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )
 #endif
@@ -886,6 +894,12 @@
     #define configUSE_POSIX_ERRNO    0
 #endif
 
+/* Set to 1 by a port that provides FieldLayout (e.g. the fault injection
+ * simulator) to export the field layouts of the kernel structures. */
+#ifndef configEXPORT_FIELD_LAYOUT
+    #define configEXPORT_FIELD_LAYOUT    0
+#endif
+
 #ifndef portTICK_TYPE_IS_ATOMIC
     #define portTICK_TYPE_IS_ATOMIC    0
 #endif
@@ -770,6 +770,10 @@ void vEventGroupClearBitsCallback( void * pvEventGroup,
 
     size_t getEventGroup_FixedSize();
 
+    #if ( configEXPORT_FIELD_LAYOUT == 1 )
+        const FieldLayout * getEventGroup_Fields( size_t * pxCount );
+    #endif
+
     size_t getEventGroup_CurrentExplodedSize(EventGroupHandle_t xHandle);
 
 /* *INDENT-OFF* */
@@ -492,6 +492,12 @@ UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove ) PRIVILEGED_FUNCTIO
 
 size_t getList_FixedSize(void);
 
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+    const FieldLayout * getList_Fields( size_t * pxCount );
+
+    const FieldLayout * getListItem_Fields( size_t * pxCount );
+#endif
+
 size_t getList_CurrentExplodedSize(List_t* xHandle);
 
 /* *INDENT-OFF* */
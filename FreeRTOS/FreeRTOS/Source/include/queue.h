@@ -52,6 +52,10 @@ typedef struct QueueDefinition   * QueueHandle_t;
 
 /* EXTENDED FUNCTIONS */
 size_t getQueue_FixedSize();
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+    const FieldLayout * getQueue_Fields( size_t * pxCount );
+    const FieldLayout * getSemaphore_UnionFields( size_t * pxCount );
+#endif
 size_t getQueue_CurrentExplodedSize(QueueHandle_t xHandle);
 void printQueueFields(QueueHandle_t xHandle);
 void getQueue_NextExpansion(QueueHandle_t xHandle, size_t byte_number, void** byte_to_inject, void** addr_to_read, size_t *size_to_read);
@@ -862,6 +862,10 @@ size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
 
 size_t getStreamBuffer_FixedSize();
 
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+    const FieldLayout * getStreamBuffer_Fields( size_t * pxCount );
+#endif
+
 size_t getStreamBuffer_CurrentExplodedSize(StreamBufferHandle_t xHandle);
 
 /* *INDENT-OFF* */
@@ -88,7 +88,13 @@ typedef struct tskTaskControlBlock * TaskHandle_t;
 
 /* EXTENDED FUNCTIONS */
 size_t getTCB_FixedSize();
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+    const FieldLayout * getTCB_Fields( size_t * pxCount );
+#endif
 size_t getTCB_CurrentExplodedSize(TaskHandle_t xHandle);
+size_t getTCB_RunTimeCounterOffset();
+void* getReadyTasksLists();
+size_t getReadyTasksLists_Size();
 
 /* -------------------------------- */
 
@@ -1351,6 +1351,10 @@ BaseType_t xTimerGenericCommand( TimerHandle_t xTimer,
 
     size_t getTimer_FixedSize();
 
+    #if ( configEXPORT_FIELD_LAYOUT == 1 )
+        const FieldLayout * getTimer_Fields( size_t * pxCount );
+    #endif
+
     size_t getTimer_CurrentExplodedSize(TimerHandle_t xHandle);
 
 /* *INDENT-OFF* */
@@ -219,6 +219,52 @@ size_t getList_FixedSize(void)
     return sizeof(List_t);
 }
 
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+
+    static const FieldLayout xListFields[] =
+    {
+        #if ( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
+            FIELD_LAYOUT( List_t, xListIntegrityValue1, FIELD_KIND_VALUE ),
+        #endif
+        FIELD_LAYOUT( List_t, uxNumberOfItems, FIELD_KIND_COUNTER ),
+        FIELD_LAYOUT( List_t, pxIndex, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( List_t, xListEnd.xItemValue, FIELD_KIND_VALUE ),
+        FIELD_LAYOUT( List_t, xListEnd.pxNext, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( List_t, xListEnd.pxPrevious, FIELD_KIND_POINTER ),
+        #if ( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
+            FIELD_LAYOUT( List_t, xListIntegrityValue2, FIELD_KIND_VALUE ),
+        #endif
+    };
+
+    static const FieldLayout xListItemFields[] =
+    {
+        #if ( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
+            FIELD_LAYOUT( ListItem_t, xListItemIntegrityValue1, FIELD_KIND_VALUE ),
+        #endif
+        FIELD_LAYOUT( ListItem_t, xItemValue, FIELD_KIND_VALUE ),
+        FIELD_LAYOUT( ListItem_t, pxNext, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( ListItem_t, pxPrevious, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( ListItem_t, pvOwner, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( ListItem_t, pxContainer, FIELD_KIND_POINTER ),
+        #if ( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
+            FIELD_LAYOUT( ListItem_t, xListItemIntegrityValue2, FIELD_KIND_VALUE ),
+        #endif
+    };
+
+    const FieldLayout * getList_Fields( size_t * pxCount )
+    {
+        *pxCount = FIELD_LAYOUT_COUNT( xListFields );
+        return xListFields;
+    }
+
+    const FieldLayout * getListItem_Fields( size_t * pxCount )
+    {
+        *pxCount = FIELD_LAYOUT_COUNT( xListItemFields );
+        return xListItemFields;
+    }
+
+#endif /* configEXPORT_FIELD_LAYOUT */
+
 size_t getList_CurrentExplodedSize(List_t* xHandle)
 {
     return sizeof(*xHandle);
@@ -76,6 +76,11 @@ typedef struct THREAD
     void *pvParams;
     BaseType_t xDying;
     struct event *ev;
+    /* Live part of the pthread stack (it grows down), read by the fault injector. */
+    void *pvStackHigh;              /* Frame of prvWaitForStart(), the frames of the task are below it. */
+    void *pvStackPointer;           /* Stack pointer at the last suspension. */
+    void *pvStackPeak;              /* Lowest stack pointer at a suspension (high-water mark). */
+    volatile BaseType_t xSuspended;
 } Thread_t;
 
 /*
@@ -143,6 +148,10 @@ int iRet;
     thread->pxCode = pxCode;
     thread->pvParams = pvParameters;
     thread->xDying = pdFALSE;
+    thread->pvStackHigh = NULL;
+    thread->pvStackPointer = NULL;
+    thread->pvStackPeak = NULL;
+    thread->xSuspended = pdFALSE;
 
     pthread_attr_init( &xThreadAttributes );
     pthread_attr_setstack( &xThreadAttributes, pxEndOfStack, ulStackSize );
@@ -427,6 +436,8 @@ static void *prvWaitForStart( void * pvParams )
 {
 Thread_t *pxThread = pvParams;
 
+    pxThread->pvStackHigh = __builtin_frame_address( 0 );
+
     prvSuspendSelf(pxThread);
 
     /* Resumed for the first time, unblocks all signals. */
@@ -490,7 +501,20 @@ static void prvSuspendSelf( Thread_t *thread )
      *
      * - A thread with all signals blocked with pthread_sigmask().
         */
+    void *pvStackPointer = __builtin_frame_address( 0 );
+
+    /* Only the frames above the suspension point are in use while the thread
+    is suspended (the wait itself is not a fault injection target). */
+    thread->pvStackPointer = pvStackPointer;
+    if( thread->pvStackPeak == NULL || pvStackPointer < thread->pvStackPeak )
+    {
+        thread->pvStackPeak = pvStackPointer;
+    }
+    thread->xSuspended = pdTRUE;
+
     event_wait(thread->ev);
+
+    thread->xSuspended = pdFALSE;
 }
 
 /*-----------------------------------------------------------*/
@@ -562,3 +586,39 @@ struct tms xTimes;
     return ( unsigned long ) xTimes.tms_utime;
 }
 /*-----------------------------------------------------------*/
+
+/* Bound on the live stack of a thread, any larger span is not a live stack. */
+#define portMAX_LIVE_STACK_SIZE     ( 8 * 1024 * 1024 )
+
+size_t xPortGetThreadSize( void )
+{
+    return sizeof( Thread_t );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortGetThreadAddress( void *pvTopOfStack )
+{
+    /* See prvGetThreadFromTask(). */
+    return ( Thread_t * )( ( StackType_t * )pvTopOfStack + 1 );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetThreadLiveStack( const void *pvThread, void **ppvLow, void **ppvHigh )
+{
+const Thread_t *pxThread = pvThread;
+
+    /* A suspended thread only uses the stack above its suspension point, a
+    running one may be anywhere down to the deepest point seen so far. */
+    *ppvLow = pxThread->xSuspended ? pxThread->pvStackPointer : pxThread->pvStackPeak;
+    *ppvHigh = pxThread->pvStackHigh;
+
+    if( *ppvLow == NULL || *ppvHigh == NULL || *ppvLow > *ppvHigh ||
+        ( size_t )( ( char * )*ppvHigh - ( char * )*ppvLow ) > portMAX_LIVE_STACK_SIZE )
+    {
+        /* The thread has not started yet, or this is not the data of a live
+        thread (e.g. the TCB of a deleted task has been reused). */
+        *ppvLow = NULL;
+        *ppvHigh = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
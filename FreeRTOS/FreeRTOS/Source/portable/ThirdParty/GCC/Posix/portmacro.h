@@ -110,6 +110,16 @@ extern void vPortCancelThread( void *pxTaskToDelete );
 #define portCLEAN_UP_TCB( pxTCB )	vPortCancelThread( pxTCB )
 /*-----------------------------------------------------------*/
 
+/*
+ * Each task runs on the stack of its pthread, not on the FreeRTOS stack, which
+ * only holds the thread data. These let the fault injector locate the live part
+ * of the pthread stack of a task from (a copy of) the thread data.
+ */
+extern size_t xPortGetThreadSize( void );
+extern void *pvPortGetThreadAddress( void *pvTopOfStack );
+extern void vPortGetThreadLiveStack( const void *pvThread, void **ppvLow, void **ppvHigh );
+/*-----------------------------------------------------------*/
+
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
 /*-----------------------------------------------------------*/
@@ -125,8 +135,13 @@ extern void vPortCancelThread( void *pxTaskToDelete );
 #define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
 
 extern unsigned long ulPortGetRunTime( void );
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() /* no-op */
-#define portGET_RUN_TIME_COUNTER_VALUE()         ulPortGetRunTime()
+/* The application may provide its own run time counter in FreeRTOSConfig.h. */
+#ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+    #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() /* no-op */
+#endif
+#ifndef portGET_RUN_TIME_COUNTER_VALUE
+    #define portGET_RUN_TIME_COUNTER_VALUE()         ulPortGetRunTime()
+#endif
 
 #ifdef __cplusplus
 }
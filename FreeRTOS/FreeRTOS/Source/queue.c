@@ -3108,6 +3108,55 @@ size_t getQueue_FixedSize()
 {
     return sizeof(xQUEUE);
 }
+
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+
+    static const FieldLayout xQueueFields[] =
+    {
+        FIELD_LAYOUT( xQUEUE, pcHead, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( xQUEUE, pcWriteTo, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( xQUEUE, u.xQueue.pcTail, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( xQUEUE, u.xQueue.pcReadFrom, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( xQUEUE, xTasksWaitingToSend, FIELD_KIND_LIST ),
+        FIELD_LAYOUT( xQUEUE, xTasksWaitingToReceive, FIELD_KIND_LIST ),
+        FIELD_LAYOUT( xQUEUE, uxMessagesWaiting, FIELD_KIND_COUNTER ),
+        FIELD_LAYOUT( xQUEUE, uxLength, FIELD_KIND_COUNTER ),
+        FIELD_LAYOUT( xQUEUE, uxItemSize, FIELD_KIND_COUNTER ),
+        FIELD_LAYOUT( xQUEUE, cRxLock, FIELD_KIND_FLAG ),
+        FIELD_LAYOUT( xQUEUE, cTxLock, FIELD_KIND_FLAG ),
+        #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+            FIELD_LAYOUT( xQUEUE, ucStaticallyAllocated, FIELD_KIND_FLAG ),
+        #endif
+        #if ( configUSE_QUEUE_SETS == 1 )
+            FIELD_LAYOUT( xQUEUE, pxQueueSetContainer, FIELD_KIND_POINTER ),
+        #endif
+        #if ( configUSE_TRACE_FACILITY == 1 )
+            FIELD_LAYOUT( xQUEUE, uxQueueNumber, FIELD_KIND_VALUE ),
+            FIELD_LAYOUT( xQUEUE, ucQueueType, FIELD_KIND_FLAG ),
+        #endif
+    };
+
+    /* The union as seen when the structure is used as a semaphore (or a mutex) */
+    static const FieldLayout xSemaphoreUnionFields[] =
+    {
+        FIELD_LAYOUT( xQUEUE, u.xSemaphore.xMutexHolder, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( xQUEUE, u.xSemaphore.uxRecursiveCallCount, FIELD_KIND_COUNTER ),
+    };
+
+    const FieldLayout * getQueue_Fields( size_t * pxCount )
+    {
+        *pxCount = FIELD_LAYOUT_COUNT( xQueueFields );
+        return xQueueFields;
+    }
+
+    const FieldLayout * getSemaphore_UnionFields( size_t * pxCount )
+    {
+        *pxCount = FIELD_LAYOUT_COUNT( xSemaphoreUnionFields );
+        return xSemaphoreUnionFields;
+    }
+
+#endif /* configEXPORT_FIELD_LAYOUT */
+
 size_t getQueue_CurrentExplodedSize(QueueHandle_t xHandle)
 {
     xQUEUE* q = (xQUEUE*)xHandle;
@@ -1311,6 +1311,31 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
         return sizeof(StreamBuffer_t);
     }
 
+    #if ( configEXPORT_FIELD_LAYOUT == 1 )
+
+        static const FieldLayout xStreamBufferFields[] =
+        {
+            FIELD_LAYOUT( StreamBuffer_t, xTail, FIELD_KIND_COUNTER ),
+            FIELD_LAYOUT( StreamBuffer_t, xHead, FIELD_KIND_COUNTER ),
+            FIELD_LAYOUT( StreamBuffer_t, xLength, FIELD_KIND_COUNTER ),
+            FIELD_LAYOUT( StreamBuffer_t, xTriggerLevelBytes, FIELD_KIND_COUNTER ),
+            FIELD_LAYOUT( StreamBuffer_t, xTaskWaitingToReceive, FIELD_KIND_POINTER ),
+            FIELD_LAYOUT( StreamBuffer_t, xTaskWaitingToSend, FIELD_KIND_POINTER ),
+            FIELD_LAYOUT( StreamBuffer_t, pucBuffer, FIELD_KIND_POINTER ),
+            FIELD_LAYOUT( StreamBuffer_t, ucFlags, FIELD_KIND_FLAG ),
+            #if ( configUSE_TRACE_FACILITY == 1 )
+                FIELD_LAYOUT( StreamBuffer_t, uxStreamBufferNumber, FIELD_KIND_VALUE ),
+            #endif
+        };
+
+        const FieldLayout * getStreamBuffer_Fields( size_t * pxCount )
+        {
+            *pxCount = FIELD_LAYOUT_COUNT( xStreamBufferFields );
+            return xStreamBufferFields;
+        }
+
+    #endif /* configEXPORT_FIELD_LAYOUT */
+
     size_t getStreamBuffer_CurrentExplodedSize(StreamBufferHandle_t xHandle)
     {
         StreamBuffer_t* p = (StreamBuffer_t*)xHandle;
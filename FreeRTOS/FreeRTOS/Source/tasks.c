@@ -1335,6 +1335,10 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
             mtCOVERAGE_TEST_MARKER();
         }
 
+        /* The task runs again: its activation for xTimeToWake (already passed
+         * if it did not delay). */
+        traceTASK_DELAY_UNTIL_RELEASED( xTimeToWake, xTimeIncrement );
+
         return xShouldDelay;
     }
 
@@ -5454,16 +5458,99 @@ void log_tasks_struct(void) {
 #if ( INCLUDE_vTaskSuspend == 1 )
     log_struct("SuspendedTasksList", TYPE_LIST, &xSuspendedTaskList);
 #endif
+
+    log_symbol("TickCount", (void *) &xTickCount);
 }
 
 size_t getTCB_FixedSize()
 {
     return sizeof(tskTCB);
 }
+
+#if ( configEXPORT_FIELD_LAYOUT == 1 )
+
+    static const FieldLayout xTCBFields[] =
+    {
+        FIELD_LAYOUT( tskTCB, pxTopOfStack, FIELD_KIND_POINTER ),
+        #if ( portUSING_MPU_WRAPPERS == 1 )
+            FIELD_LAYOUT( tskTCB, xMPUSettings, FIELD_KIND_VALUE ),
+        #endif
+        FIELD_LAYOUT( tskTCB, xStateListItem, FIELD_KIND_LIST_ITEM ),
+        FIELD_LAYOUT( tskTCB, xEventListItem, FIELD_KIND_LIST_ITEM ),
+        FIELD_LAYOUT( tskTCB, uxPriority, FIELD_KIND_VALUE ),
+        FIELD_LAYOUT( tskTCB, pxStack, FIELD_KIND_POINTER ),
+        FIELD_LAYOUT( tskTCB, pcTaskName, FIELD_KIND_VALUE ),
+        #if ( ( portSTACK_GROWTH > 0 ) || ( configRECORD_STACK_HIGH_ADDRESS == 1 ) )
+            FIELD_LAYOUT( tskTCB, pxEndOfStack, FIELD_KIND_POINTER ),
+        #endif
+        #if ( portCRITICAL_NESTING_IN_TCB == 1 )
+            FIELD_LAYOUT( tskTCB, uxCriticalNesting, FIELD_KIND_COUNTER ),
+        #endif
+        #if ( configUSE_TRACE_FACILITY == 1 )
+            FIELD_LAYOUT( tskTCB, uxTCBNumber, FIELD_KIND_VALUE ),
+            FIELD_LAYOUT( tskTCB, uxTaskNumber, FIELD_KIND_VALUE ),
+        #endif
+        #if ( configUSE_MUTEXES == 1 )
+            FIELD_LAYOUT( tskTCB, uxBasePriority, FIELD_KIND_VALUE ),
+            FIELD_LAYOUT( tskTCB, uxMutexesHeld, FIELD_KIND_COUNTER ),
+        #endif
+        #if ( configUSE_APPLICATION_TASK_TAG == 1 )
+            FIELD_LAYOUT( tskTCB, pxTaskTag, FIELD_KIND_POINTER ),
+        #endif
+        #if ( configNUM_THREAD_LOCAL_STORAGE_POINTERS > 0 )
+            FIELD_LAYOUT( tskTCB, pvThreadLocalStoragePointers, FIELD_KIND_POINTER ),
+        #endif
+        #if ( configGENERATE_RUN_TIME_STATS == 1 )
+            FIELD_LAYOUT( tskTCB, ulRunTimeCounter, FIELD_KIND_COUNTER ),
+        #endif
+        #if ( configUSE_NEWLIB_REENTRANT == 1 )
+            FIELD_LAYOUT( tskTCB, xNewLib_reent, FIELD_KIND_VALUE ),
+        #endif
+        #if ( configUSE_TASK_NOTIFICATIONS == 1 )
+            FIELD_LAYOUT( tskTCB, ulNotifiedValue, FIELD_KIND_VALUE ),
+            FIELD_LAYOUT( tskTCB, ucNotifyState, FIELD_KIND_FLAG ),
+        #endif
+        #if ( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
+            FIELD_LAYOUT( tskTCB, ucStaticallyAllocated, FIELD_KIND_FLAG ),
+        #endif
+        #if ( INCLUDE_xTaskAbortDelay == 1 )
+            FIELD_LAYOUT( tskTCB, ucDelayAborted, FIELD_KIND_FLAG ),
+        #endif
+        #if ( configUSE_POSIX_ERRNO == 1 )
+            FIELD_LAYOUT( tskTCB, iTaskErrno, FIELD_KIND_VALUE ),
+        #endif
+    };
+
+    const FieldLayout * getTCB_Fields( size_t * pxCount )
+    {
+        *pxCount = FIELD_LAYOUT_COUNT( xTCBFields );
+        return xTCBFields;
+    }
+
+#endif /* configEXPORT_FIELD_LAYOUT */
+
 size_t getTCB_CurrentExplodedSize(TaskHandle_t xHandle)
 {
     // TODO: Perform analysis on lists and vectors...
 
     tskTCB* p = (tskTCB*)xHandle;
     return sizeof(*p);
+}
+
+/* Offset of the run time counter, which differs between runs even when the task state is the same */
+size_t getTCB_RunTimeCounterOffset()
+{
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+    return offsetof(tskTCB, ulRunTimeCounter);
+#else
+    return sizeof(tskTCB);
+#endif
+}
+void* getReadyTasksLists()
+{
+    return pxReadyTasksLists;
+}
+size_t getReadyTasksLists_Size()
+{
+    return sizeof(pxReadyTasksLists);
 }
\ No newline at end of file
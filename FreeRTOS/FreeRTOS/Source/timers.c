@@ -547,6 +547,7 @@
          * expiry time and re-insert the timer in the list of active timers. */
         if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
         {
+            traceTIMER_RELEASED( pxTimer, xNextExpireTime, xTimeNow );
             prvReloadTimer( pxTimer, xNextExpireTime, xTimeNow );
         }
         else
@@ -1130,6 +1131,29 @@
         return sizeof(xTIMER);
     }
 
+    #if ( configEXPORT_FIELD_LAYOUT == 1 )
+
+        static const FieldLayout xTimerFields[] =
+        {
+            FIELD_LAYOUT( xTIMER, pcTimerName, FIELD_KIND_POINTER ),
+            FIELD_LAYOUT( xTIMER, xTimerListItem, FIELD_KIND_LIST_ITEM ),
+            FIELD_LAYOUT( xTIMER, xTimerPeriodInTicks, FIELD_KIND_VALUE ),
+            FIELD_LAYOUT( xTIMER, pvTimerID, FIELD_KIND_POINTER ),
+            FIELD_LAYOUT( xTIMER, pxCallbackFunction, FIELD_KIND_POINTER ),
+            #if ( configUSE_TRACE_FACILITY == 1 )
+                FIELD_LAYOUT( xTIMER, uxTimerNumber, FIELD_KIND_VALUE ),
+            #endif
+            FIELD_LAYOUT( xTIMER, ucStatus, FIELD_KIND_FLAG ),
+        };
+
+        const FieldLayout * getTimer_Fields( size_t * pxCount )
+        {
+            *pxCount = FIELD_LAYOUT_COUNT( xTimerFields );
+            return xTimerFields;
+        }
+
+    #endif /* configEXPORT_FIELD_LAYOUT */
+
     size_t getTimer_CurrentExplodedSize(TimerHandle_t xHandle)
     {
         xTIMER* p = (xTIMER*)xHandle;
@@ -43,7 +43,11 @@
 /* Custom includes */
 #include "simulator_config.h"
 #include "memory_logger.h"
+#include "field_layout.h"
 #include "console.h"
+#include "task_stats.h"
+#include "deadline_stats.h"
+#include "trigger.h"
 
 #if defined __unix__
     #include <pthread.h>
@@ -99,6 +103,9 @@
 
 #define configMAX_PRIORITIES					( 20 )
 
+/* Field layouts of the kernel structures (see field_layout.h), for the FaultInjector. */
+#define configEXPORT_FIELD_LAYOUT				1
+
 /* Co-routine related configuration options. */
 #define configUSE_CO_ROUTINES 					0
 #define configMAX_CO_ROUTINE_PRIORITIES			( 2 )
@@ -117,6 +124,26 @@ FreeRTOS/Source/tasks.c for limitations. */
     #define configSTACK_DEPTH_TYPE              uint32_t
 #endif
 
+/* Run time stats: the counter is a monotonic clock in microseconds, read through
+the vDSO, so that taking it at every context switch is cheap.  The number of times
+each task is switched in is counted by the trace hook. */
+#define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	task_stats_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()		task_stats_get_run_time_counter()
+#define traceTASK_SWITCHED_IN()					do { task_stats_switched_in( pxCurrentTCB->uxTCBNumber ); trigger_hit( TRIGGER_HOOK_TASK_SWITCHED_IN ); } while( 0 )
+
+/* Deadline misses: the activations of the periodic tasks (xTaskDelayUntil()) and of the
+auto-reload timers are compared with their release tick. */
+#define traceTASK_DELAY_UNTIL_RELEASED( xTimeToWake, xTimeIncrement )	deadline_stats_task_released( pxCurrentTCB->uxTCBNumber, pxCurrentTCB->pcTaskName, xTimeIncrement, xTimeToWake, xTickCount )
+#define traceTIMER_RELEASED( pxTimer, xExpireTime, xTimeNow )			deadline_stats_timer_released( pxTimer, pxTimer->pcTimerName, pxTimer->xTimerPeriodInTicks, xExpireTime, xTimeNow )
+
+/* Injection triggers: every hook counts its occurrences, and the simulator stops at the
+occurrence armed by the FaultInjector until the fault is injected (see trigger.h). */
+#define traceQUEUE_SEND( pxQueue )				trigger_hit( TRIGGER_HOOK_QUEUE_SEND )
+#define traceQUEUE_RECEIVE( pxQueue )			trigger_hit( TRIGGER_HOOK_QUEUE_RECEIVE )
+#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )	trigger_hit( TRIGGER_HOOK_TIMER_COMMAND_RECEIVED )
+#define traceTASK_INCREMENT_TICK( xTickCount )		trigger_hit( TRIGGER_HOOK_TASK_INCREMENT_TICK )
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function.  In most cases the linker will remove unused
 functions anyway. */
@@ -153,4 +180,12 @@ extern void vAssertCalledM(unsigned long ulLine, const char* const pcFileName, c
 	#define sbSEND_COMPLETED( pxStreamBuffer ) vGenerateCoreBInterrupt( pxStreamBuffer )
 #endif /* configINCLUDE_MESSAGE_BUFFER_AMP_DEMO */
 
+#if defined TRACE_RECORDER
+/* Include the FreeRTOS+Trace FreeRTOS trace macro definitions.  The recorder
+redefines traceTASK_SWITCHED_IN(), so the task switch counts of the run time
+stats are not collected in this build (the switches are in the trace), and the
+injection trigger hooks it redefines too are never reached. */
+    #include "trcRecorder.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,344 @@
+/*
+ * Kernel primitive microbenchmarks.
+ *
+ * Built from the same kernel sources, port and FreeRTOSConfig.h of the
+ * simulator, it measures the cost of the kernel hot paths the simulator spends
+ * its time on: queue send/receive, semaphore give/take, task notifications,
+ * vTaskDelay() and a forced context switch between two tasks.
+ * Each operation is timed individually and reported as ns/op with percentiles,
+ * both on stdout and in a JSON file, to get a baseline before changing the
+ * port or the kernel configuration.
+ *
+ * Usage: FreeRTOS_KernelBench [output_file]
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Platform-dependent. */
+#if defined _WIN32
+    #include <windows.h>
+#elif defined __unix__
+    #include <time.h>
+#endif
+
+/* FreeRTOS kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <queue.h>
+#include <semphr.h>
+
+#include "heap_arena.h"
+
+/* Number of timed iterations of each primitive. */
+#define benchITERATIONS             ( 10000 )
+
+/* vTaskDelay() lasts at least one tick, so fewer iterations are enough. */
+#define benchDELAY_ITERATIONS       ( 200 )
+
+/* Untimed iterations executed before each measurement. */
+#define benchWARMUP_ITERATIONS      ( 100 )
+
+#define benchTASK_PRIORITY          ( configMAX_PRIORITIES - 2 )
+#define benchQUEUE_LENGTH           ( 1 )
+
+#define benchDEFAULT_OUTPUT         "kernel_bench.json"
+
+/*-----------------------------------------------------------*/
+
+static void prvBenchTask( void *pvParameters );
+static void prvSwitchPeerTask( void *pvParameters );
+static uint64_t prvGetTimeNs( void );
+static void prvReport( const char *pcName, uint64_t *pullSamples, uint32_t ulCount );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t ullSamplesA[ benchITERATIONS ];
+static uint64_t ullSamplesB[ benchITERATIONS ];
+
+/* Shared with prvSwitchPeerTask() to time the forced context switches. */
+static volatile uint64_t ullSwitchStart = 0;
+static volatile uint32_t ulSwitchCount = 0;
+
+static FILE *pxResultsFile = NULL;
+static BaseType_t xFirstResult = pdTRUE;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char **argv )
+{
+    const char *pcOutputPath = ( argc > 1 ) ? argv[ 1 ] : benchDEFAULT_OUTPUT;
+
+    #if defined HEAP_ARENA
+        heap_arena_init();
+    #endif
+
+    pxResultsFile = fopen( pcOutputPath, "w" );
+    if( pxResultsFile == NULL )
+    {
+        fprintf( stderr, "Unable to open %s for writing the benchmark results.\n", pcOutputPath );
+        exit( 1 );
+    }
+    fprintf( pxResultsFile, "{\n  \"tick_rate_hz\": %d,\n  \"results\": [\n", configTICK_RATE_HZ );
+
+    #if defined TRACE_RECORDER
+        /* Measure the primitives with the recorder overhead included. */
+        vTraceEnable( TRC_START );
+    #endif
+
+    printf( "%-24s %10s %10s %10s %10s %10s %10s\n", "Primitive", "Iterations", "Mean ns", "p50 ns", "p90 ns", "p99 ns", "Max ns" );
+
+    xTaskCreate( prvBenchTask, "Bench", configMINIMAL_STACK_SIZE * 2, NULL, benchTASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* Should never get here unless there was not enough heap space to create
+     * the idle and other system tasks. */
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTask( void *pvParameters )
+{
+    QueueHandle_t xQueue;
+    SemaphoreHandle_t xSemaphore;
+    TaskHandle_t xPeer;
+    uint32_t ulValue = 0, ulReceived;
+    uint64_t ullStart;
+    uint32_t i;
+
+    ( void ) pvParameters;
+
+    xQueue = xQueueCreate( benchQUEUE_LENGTH, sizeof( uint32_t ) );
+    xSemaphore = xSemaphoreCreateBinary();
+    configASSERT( xQueue );
+    configASSERT( xSemaphore );
+
+    /* Queue send / receive, never blocking. */
+    for( i = 0; i < benchWARMUP_ITERATIONS; i++ )
+    {
+        xQueueSend( xQueue, &ulValue, 0 );
+        xQueueReceive( xQueue, &ulReceived, 0 );
+    }
+    for( i = 0; i < benchITERATIONS; i++ )
+    {
+        ullStart = prvGetTimeNs();
+        xQueueSend( xQueue, &ulValue, 0 );
+        ullSamplesA[ i ] = prvGetTimeNs() - ullStart;
+
+        ullStart = prvGetTimeNs();
+        xQueueReceive( xQueue, &ulReceived, 0 );
+        ullSamplesB[ i ] = prvGetTimeNs() - ullStart;
+    }
+    prvReport( "xQueueSend", ullSamplesA, benchITERATIONS );
+    prvReport( "xQueueReceive", ullSamplesB, benchITERATIONS );
+
+    /* Binary semaphore give / take, never blocking. */
+    for( i = 0; i < benchWARMUP_ITERATIONS; i++ )
+    {
+        xSemaphoreGive( xSemaphore );
+        xSemaphoreTake( xSemaphore, 0 );
+    }
+    for( i = 0; i < benchITERATIONS; i++ )
+    {
+        ullStart = prvGetTimeNs();
+        xSemaphoreGive( xSemaphore );
+        ullSamplesA[ i ] = prvGetTimeNs() - ullStart;
+
+        ullStart = prvGetTimeNs();
+        xSemaphoreTake( xSemaphore, 0 );
+        ullSamplesB[ i ] = prvGetTimeNs() - ullStart;
+    }
+    prvReport( "xSemaphoreGive", ullSamplesA, benchITERATIONS );
+    prvReport( "xSemaphoreTake", ullSamplesB, benchITERATIONS );
+
+    /* Task notification to self, never blocking. */
+    for( i = 0; i < benchWARMUP_ITERATIONS; i++ )
+    {
+        xTaskNotifyGive( xTaskGetCurrentTaskHandle() );
+        ulTaskNotifyTake( pdTRUE, 0 );
+    }
+    for( i = 0; i < benchITERATIONS; i++ )
+    {
+        ullStart = prvGetTimeNs();
+        xTaskNotifyGive( xTaskGetCurrentTaskHandle() );
+        ullSamplesA[ i ] = prvGetTimeNs() - ullStart;
+
+        ullStart = prvGetTimeNs();
+        ulTaskNotifyTake( pdTRUE, 0 );
+        ullSamplesB[ i ] = prvGetTimeNs() - ullStart;
+    }
+    prvReport( "xTaskNotifyGive", ullSamplesA, benchITERATIONS );
+    prvReport( "ulTaskNotifyTake", ullSamplesB, benchITERATIONS );
+
+    /* vTaskDelay() of one tick: the expected value is the tick period. */
+    for( i = 0; i < benchDELAY_ITERATIONS; i++ )
+    {
+        ullStart = prvGetTimeNs();
+        vTaskDelay( 1 );
+        ullSamplesA[ i ] = prvGetTimeNs() - ullStart;
+    }
+    prvReport( "vTaskDelay(1)", ullSamplesA, benchDELAY_ITERATIONS );
+
+    /* Forced context switch: yield to a ready task of the same priority,
+     * which takes the timestamp as soon as it is resumed. */
+    xTaskCreate( prvSwitchPeerTask, "Peer", configMINIMAL_STACK_SIZE * 2, NULL, benchTASK_PRIORITY, &xPeer );
+    for( i = 0; i < benchWARMUP_ITERATIONS; i++ )
+    {
+        taskYIELD();
+    }
+    ulSwitchCount = 0;
+    for( i = 0; i < benchITERATIONS; i++ )
+    {
+        ullSwitchStart = prvGetTimeNs();
+        taskYIELD();
+    }
+    vTaskDelete( xPeer );
+    prvReport( "taskYIELD switch", ullSamplesA, ulSwitchCount );
+
+    fprintf( pxResultsFile, "\n  ]\n}\n" );
+    fclose( pxResultsFile );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchPeerTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ;; )
+    {
+        if( ullSwitchStart != 0 && ulSwitchCount < benchITERATIONS )
+        {
+            ullSamplesA[ ulSwitchCount++ ] = prvGetTimeNs() - ullSwitchStart;
+            ullSwitchStart = 0;
+        }
+
+        taskYIELD();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetTimeNs( void )
+{
+    #if defined _WIN32
+        static LARGE_INTEGER xFrequency = { 0 };
+        LARGE_INTEGER xCounter;
+
+        if( xFrequency.QuadPart == 0 )
+        {
+            QueryPerformanceFrequency( &xFrequency );
+        }
+        QueryPerformanceCounter( &xCounter );
+
+        return ( uint64_t ) ( ( double ) xCounter.QuadPart * 1000000000.0 / ( double ) xFrequency.QuadPart );
+    #elif defined __unix__
+        struct timespec t;
+
+        clock_gettime( CLOCK_MONOTONIC, &t );
+
+        return ( uint64_t ) t.tv_sec * 1000000000ull + ( uint64_t ) t.tv_nsec;
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareSamples( const void *pvA, const void *pvB )
+{
+    uint64_t a = *( const uint64_t * ) pvA;
+    uint64_t b = *( const uint64_t * ) pvB;
+
+    return ( a > b ) - ( a < b );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcName, uint64_t *pullSamples, uint32_t ulCount )
+{
+    uint64_t ullSum = 0, ullP50, ullP90, ullP99, ullMax;
+    double dMean;
+    uint32_t i;
+
+    if( ulCount == 0 )
+    {
+        return;
+    }
+
+    qsort( pullSamples, ulCount, sizeof( uint64_t ), prvCompareSamples );
+
+    for( i = 0; i < ulCount; i++ )
+    {
+        ullSum += pullSamples[ i ];
+    }
+
+    dMean = ( double ) ullSum / ( double ) ulCount;
+    ullP50 = pullSamples[ ( ulCount * 50 ) / 100 ];
+    ullP90 = pullSamples[ ( ulCount * 90 ) / 100 ];
+    ullP99 = pullSamples[ ( ulCount * 99 ) / 100 ];
+    ullMax = pullSamples[ ulCount - 1 ];
+
+    printf( "%-24s %10u %10.1f %10llu %10llu %10llu %10llu\n", pcName, ( unsigned ) ulCount, dMean,
+            ( unsigned long long ) ullP50, ( unsigned long long ) ullP90, ( unsigned long long ) ullP99, ( unsigned long long ) ullMax );
+
+    fprintf( pxResultsFile, "%s    { \"name\": \"%s\", \"iterations\": %u, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu }",
+             xFirstResult ? "" : ",\n", pcName, ( unsigned ) ulCount, dMean,
+             ( unsigned long long ) ullP50, ( unsigned long long ) ullP90, ( unsigned long long ) ullP99, ( unsigned long long ) ullMax );
+    xFirstResult = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/* Application hooks required by FreeRTOSConfig.h of the simulator. */
+
+void vAssertCalled( unsigned long ulLine, const char * const pcFileName )
+{
+    fprintf( stderr, "Assertion failed on line %ld, file %s\n", ulLine, pcFileName );
+    exit( 2 );
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalledM( unsigned long ulLine, const char * const pcFileName, const char * const message )
+{
+    fprintf( stderr, "Assertion failed on line %ld, file %s - ERROR: %s\n", ulLine, pcFileName, message );
+    exit( 2 );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    vAssertCalled( __LINE__, __FILE__ );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationTickHook( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize )
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+/*-----------------------------------------------------------*/
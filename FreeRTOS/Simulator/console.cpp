@@ -6,16 +6,398 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <string.h>
 #include <boost/interprocess/detail/os_thread_functions.hpp>
 #include "simulator_config.h"
 
+#if defined _WIN32
+    #include <windows.h>
+#elif defined __unix__
+    #include <time.h>
+    #include <signal.h>
+    #include <pthread.h>
+#endif
+
 #include <FreeRTOS.h>
+#include <task.h>
 #include <semphr.h>
 
+/* A line printed by the simulator, stamped with the kernel tick and the monotonic time */
+typedef struct {
+    TickType_t tick;
+    unsigned long long ns;
+    std::string text;
+} OutputRecord;
+
 SemaphoreHandle_t xStdioMutex;
 StaticSemaphore_t xStdioMutexBuffer;
 
-std::vector<std::string> output;
+std::vector<OutputRecord> output;
+
+static unsigned long long monotonic_ns(void) {
+#if defined _WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (unsigned long long)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#elif defined __unix__
+    // Same clock of std::chrono::steady_clock in the injector
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return (unsigned long long)t.tv_sec * 1000000000ULL + (unsigned long long)t.tv_nsec;
+#endif
+}
+
+#if defined CONSOLE_DEFERRED
+
+enum ConsoleArgKind {
+    ARG_INT,
+    ARG_LONG,
+    ARG_LONG_LONG,
+    ARG_DOUBLE,
+    ARG_POINTER,
+    ARG_STRING,
+    ARG_UNSUPPORTED
+};
+
+typedef union {
+    long long i;
+    double d;
+    void* p;
+    size_t offset;
+} ConsoleArg;
+
+/* A console_print call: the format is formatted later, the strings are copied since they may be overwritten */
+typedef struct {
+    std::atomic<bool> ready;
+    unsigned long long seq;
+    TickType_t tick;
+    unsigned long long ns;
+    const char* fmt;
+    ConsoleArg args[CONSOLE_MAX_ARGS];
+    char strings[CONSOLE_STRING_BYTES];
+} ConsoleRecord;
+
+/*
+* Each task (pthread) writes in its own ring. A slot is reserved with an atomic increment,
+* so an ISR interrupting the task (or tasks beyond CONSOLE_MAX_RINGS sharing a ring) can
+* write in the same ring; the flusher reads the slots in order as soon as they are ready.
+* A ring is allocated on the first print of its task: the tasks which never print cost nothing.
+*/
+typedef struct {
+    std::atomic<unsigned long long> head;
+    std::atomic<unsigned long long> tail;
+    ConsoleRecord slots[CONSOLE_RING_SLOTS];
+} ConsoleRing;
+
+static std::atomic<ConsoleRing*> rings[CONSOLE_MAX_RINGS];
+static std::atomic<int> rings_count(0);
+static thread_local ConsoleRing* task_ring = nullptr;
+
+// Order of the console_print calls among all the rings
+static std::atomic<unsigned long long> next_seq(0);
+
+// Formatted records not written to the output yet, with their sequence number (flusher side only)
+static std::mutex flush_mutex;
+static std::vector<std::pair<unsigned long long, OutputRecord>> pending;
+
+// Set by the last flush: the rings are not drained any more
+static std::atomic<bool> flush_stopped(false);
+
+// Finds the next conversion of the format starting from p: returns where it starts ('%') or NULL
+static const char* next_conversion(const char* p, size_t* length, int* kind) {
+    while ((p = strchr(p, '%')) != NULL) {
+        const char* q = p + 1;
+        int longs = 0;
+        bool sized = false;
+
+        if (*q == '%') {
+            p = q + 1;
+            continue;
+        }
+
+        while (*q != '\0' && strchr("-+ #0123456789.", *q) != NULL)
+            q++;
+        while (*q != '\0' && strchr("hlLqjzt", *q) != NULL) {
+            if (*q == 'l')
+                longs++;
+            else if (*q == 'L' || *q == 'q')
+                longs = 2;
+            else if (*q != 'h')
+                sized = true;
+            q++;
+        }
+
+        switch (*q) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            *kind = longs >= 2 ? ARG_LONG_LONG : (longs == 1 || sized) ? ARG_LONG : ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            *kind = longs >= 2 ? ARG_UNSUPPORTED : ARG_DOUBLE;
+            break;
+        case 'p':
+            *kind = ARG_POINTER;
+            break;
+        case 's':
+            *kind = longs > 0 ? ARG_UNSUPPORTED : ARG_STRING;
+            break;
+        default:
+            // '*' width, %n, wide strings...
+            *kind = ARG_UNSUPPORTED;
+            break;
+        }
+
+        *length = (size_t)(q - p) + (*q != '\0' ? 1 : 0);
+        return p;
+    }
+
+    return NULL;
+}
+
+// Copies the raw arguments in the record. Returns false if the format can't be deferred.
+static bool capture_args(ConsoleRecord* r, const char* fmt, va_list vargs) {
+    const char* p = fmt;
+    size_t length;
+    int kind;
+    int n = 0;
+    size_t strings_used = 0;
+
+    while ((p = next_conversion(p, &length, &kind)) != NULL) {
+        if (n == CONSOLE_MAX_ARGS || kind == ARG_UNSUPPORTED)
+            return false;
+
+        switch (kind) {
+        case ARG_INT:
+            r->args[n].i = va_arg(vargs, int);
+            break;
+        case ARG_LONG:
+            r->args[n].i = va_arg(vargs, long);
+            break;
+        case ARG_LONG_LONG:
+            r->args[n].i = va_arg(vargs, long long);
+            break;
+        case ARG_DOUBLE:
+            r->args[n].d = va_arg(vargs, double);
+            break;
+        case ARG_POINTER:
+            r->args[n].p = va_arg(vargs, void*);
+            break;
+        case ARG_STRING: {
+            const char* str = va_arg(vargs, const char*);
+            size_t len = strlen(str != NULL ? str : "(null)");
+            if (strings_used + len + 1 > CONSOLE_STRING_BYTES)
+                return false;
+            memcpy(r->strings + strings_used, str != NULL ? str : "(null)", len + 1);
+            r->args[n].offset = strings_used;
+            strings_used += len + 1;
+            break;
+        }
+        }
+
+        n++;
+        p += length;
+    }
+
+    return true;
+}
+
+static std::string format_record(const ConsoleRecord* r) {
+    // Formats that could not be deferred have been formatted in the strings
+    if (r->fmt == NULL)
+        return std::string(r->strings);
+
+    std::string text;
+    const char* p = r->fmt;
+    const char* conversion;
+    size_t length;
+    int kind;
+    int n = 0;
+    char buffer[CONSOLE_STRING_BYTES + 64];
+
+    while ((conversion = next_conversion(p, &length, &kind)) != NULL) {
+        std::string literal(p, conversion - p);
+        std::string spec(conversion, length);
+
+        // "%%" in the literal parts
+        snprintf(buffer, sizeof(buffer), literal.c_str(), 0);
+        text += buffer;
+
+        switch (kind) {
+        case ARG_INT:
+            snprintf(buffer, sizeof(buffer), spec.c_str(), (int)r->args[n].i);
+            break;
+        case ARG_LONG:
+            snprintf(buffer, sizeof(buffer), spec.c_str(), (long)r->args[n].i);
+            break;
+        case ARG_LONG_LONG:
+            snprintf(buffer, sizeof(buffer), spec.c_str(), r->args[n].i);
+            break;
+        case ARG_DOUBLE:
+            snprintf(buffer, sizeof(buffer), spec.c_str(), r->args[n].d);
+            break;
+        case ARG_POINTER:
+            snprintf(buffer, sizeof(buffer), spec.c_str(), r->args[n].p);
+            break;
+        case ARG_STRING:
+            snprintf(buffer, sizeof(buffer), spec.c_str(), r->strings + r->args[n].offset);
+            break;
+        }
+        text += buffer;
+
+        n++;
+        p = conversion + length;
+    }
+
+    snprintf(buffer, sizeof(buffer), p, 0);
+    text += buffer;
+
+    return text;
+}
+
+// Moves the ready records of all the rings to the pending ones (flush_mutex held)
+static void drain_rings(void) {
+    int count = std::min(rings_count.load(), CONSOLE_MAX_RINGS);
+
+    for (int i = 0; i < count; i++) {
+        ConsoleRing* ring = rings[i].load(std::memory_order_acquire);
+        if (ring == nullptr)
+            continue;
+        unsigned long long tail = ring->tail.load(std::memory_order_relaxed);
+
+        while (true) {
+            ConsoleRecord* r = &ring->slots[tail % CONSOLE_RING_SLOTS];
+            if (!r->ready.load(std::memory_order_acquire))
+                break;
+
+            OutputRecord o;
+            o.tick = r->tick;
+            o.ns = r->ns;
+            o.text = format_record(r);
+            fputs(o.text.c_str(), stdout);
+            pending.push_back(std::make_pair(r->seq, o));
+
+            r->ready.store(false, std::memory_order_relaxed);
+            tail++;
+            ring->tail.store(tail, std::memory_order_release);
+        }
+    }
+}
+
+static void flusher(void) {
+#if defined __unix__
+    // The tick interrupt (SIGALRM) of the port must only be handled by the tasks
+    sigset_t all_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, NULL);
+#endif
+
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(CONSOLE_FLUSH_PERIOD_MS));
+
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        if (flush_stopped)
+            return;
+        drain_rings();
+    }
+}
+
+// Drains all the rings and appends the records to the output, in call order. The flusher is stopped.
+static void console_flush(void) {
+    std::lock_guard<std::mutex> lock(flush_mutex);
+
+    drain_rings();
+    flush_stopped = true;
+
+    std::stable_sort(pending.begin(), pending.end(), [](const std::pair<unsigned long long, OutputRecord>& a, const std::pair<unsigned long long, OutputRecord>& b) {
+        return a.first < b.first;
+        });
+    for (auto const& p : pending)
+        output.push_back(p.second);
+    pending.clear();
+    fflush(stdout);
+}
+
+// The ring of the n-th task which prints
+static ConsoleRing* get_ring(int n) {
+    std::atomic<ConsoleRing*>& slot = rings[n % CONSOLE_MAX_RINGS];
+    ConsoleRing* ring;
+
+    if (n < CONSOLE_MAX_RINGS) {
+        ring = new ConsoleRing();
+        slot.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    // Shared with an earlier task, which may still be allocating it
+    while ((ring = slot.load(std::memory_order_acquire)) == nullptr)
+        std::this_thread::yield();
+    return ring;
+}
+
+void console_init( void )
+{
+    std::thread(flusher).detach();
+}
+
+void console_print(const char* fmt,
+    ...) {
+    va_list vargs;
+
+    // After the last flush (the simulator is exiting) nothing drains the rings: the line is only printed
+    if (flush_stopped.load(std::memory_order_acquire)) {
+        va_start(vargs, fmt);
+        vprintf(fmt, vargs);
+        va_end(vargs);
+        return;
+    }
+
+    if (task_ring == nullptr)
+        task_ring = get_ring(rings_count.fetch_add(1));
+
+    // Reserve a slot, waiting for the flusher if the ring is full (and giving up if it has stopped)
+    unsigned long long index = task_ring->head.fetch_add(1);
+    while (index - task_ring->tail.load(std::memory_order_acquire) >= CONSOLE_RING_SLOTS) {
+        if (flush_stopped.load(std::memory_order_acquire)) {
+            va_start(vargs, fmt);
+            vprintf(fmt, vargs);
+            va_end(vargs);
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    ConsoleRecord* r = &task_ring->slots[index % CONSOLE_RING_SLOTS];
+    r->seq = next_seq.fetch_add(1);
+    r->tick = xTaskGetTickCount();
+    r->ns = monotonic_ns();
+    r->fmt = fmt;
+
+    va_start(vargs, fmt);
+    bool deferred = capture_args(r, fmt, vargs);
+    va_end(vargs);
+
+    if (!deferred) {
+        va_start(vargs, fmt);
+        vsnprintf(r->strings, CONSOLE_STRING_BYTES, fmt, vargs);
+        va_end(vargs);
+        r->fmt = NULL;
+    }
+
+    r->ready.store(true, std::memory_order_release);
+}
+
+#else
 
 void console_init( void )
 {
@@ -36,14 +418,19 @@ void console_print(const char* fmt,
     va_start(vargs, fmt);
     vsprintf(buffer, fmt, vargs);
 
-    std::string s = buffer;
-    output.push_back(s);
+    OutputRecord r;
+    r.tick = xTaskGetTickCount();
+    r.ns = monotonic_ns();
+    r.text = buffer;
+    output.push_back(r);
 
     xSemaphoreGive(xStdioMutex);
 
     va_end(vargs);
 }
 
+#endif
+
 void write_output_to_file(void) {
     std::ofstream out_file;
     std::string s1 = OUTPUT_FILE_PREFIX;
@@ -51,10 +438,22 @@ void write_output_to_file(void) {
     std::string s3 = ".txt";
     std::string path = "output/" + s1 + s2 + s3;
 
+#if defined CONSOLE_DEFERRED
+    console_flush();
+#endif
+
     out_file.open(path);
     if (out_file.is_open()) {
-        for (auto s : output) {
-            out_file << s;
+        // One line per record: "<tick> <ns>\t<text>", records spanning more lines are split
+        for (auto const& r : output) {
+            size_t begin = 0;
+            while (begin < r.text.size()) {
+                size_t end = r.text.find('\n', begin);
+                if (end == std::string::npos)
+                    end = r.text.size();
+                out_file << r.tick << " " << r.ns << "\t" << r.text.substr(begin, end - begin) << "\n";
+                begin = end + 1;
+            }
         }
     }
     else {
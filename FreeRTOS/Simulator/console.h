@@ -1,6 +1,14 @@
 #ifndef CONSOLE_H
     #define CONSOLE_H
 
+    /* Deferred mode: a task records the format and the raw arguments in a ring,
+    the lines are formatted by a flusher thread out of the simulated timeline */
+    #define CONSOLE_MAX_RINGS           64
+    #define CONSOLE_RING_SLOTS          1024
+    #define CONSOLE_MAX_ARGS            8
+    #define CONSOLE_STRING_BYTES        256
+    #define CONSOLE_FLUSH_PERIOD_MS     1
+
     #ifdef __cplusplus
         extern "C" {
     #endif
@@ -0,0 +1,86 @@
+#include "deadline_stats.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+
+#include <boost/interprocess/detail/os_thread_functions.hpp>
+#include "simulator_config.h"
+
+/* Activations of a periodic task or timer, compared with their release tick */
+typedef struct {
+    const void* timer;
+    char name[DEADLINE_STATS_NAME_LEN];
+    unsigned long period;
+    unsigned long activations;
+    unsigned long misses;
+    unsigned long worst_lateness;
+} Activations;
+
+static Activations tasks[DEADLINE_STATS_MAX_TASKS];
+static Activations timers[DEADLINE_STATS_MAX_TIMERS];
+
+static void record(Activations* a, const char* name, unsigned long period, unsigned long release, unsigned long now) {
+    // Ticks wrap around: the difference is still right
+    long lateness = (long)(now - release);
+
+    if (a->activations++ == 0)
+        strncpy(a->name, name, DEADLINE_STATS_NAME_LEN - 1);
+    a->period = period;
+
+    // Not before the release (e.g. the delay aborted): on time
+    if (lateness > 0) {
+        a->misses++;
+        if ((unsigned long)lateness > a->worst_lateness)
+            a->worst_lateness = (unsigned long)lateness;
+    }
+}
+
+void deadline_stats_task_released(unsigned long task_number, const char* name, unsigned long period, unsigned long release, unsigned long now) {
+    // Called by the task itself when it runs again: every task only writes its own entry
+    if (task_number < DEADLINE_STATS_MAX_TASKS)
+        record(&tasks[task_number], name, period, release, now);
+}
+
+void deadline_stats_timer_released(const void* timer, const char* name, unsigned long period, unsigned long release, unsigned long now) {
+    // Called by the timer service task only. The entry of a timer is found by open addressing on its address
+    size_t i = (size_t)(((uintptr_t)timer >> 4) % DEADLINE_STATS_MAX_TIMERS);
+
+    for (size_t n = 0; n < DEADLINE_STATS_MAX_TIMERS; n++) {
+        if (timers[i].timer == timer || timers[i].timer == NULL) {
+            timers[i].timer = timer;
+            record(&timers[i], name, period, release, now);
+            return;
+        }
+        i = (i + 1) % DEADLINE_STATS_MAX_TIMERS;
+    }
+}
+
+static void write_activations(FILE* fp, const char* kind, const Activations* a, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (a[i].activations > 0)
+            fprintf(fp, "%s %lu %lu %lu %lu %s\n", kind, a[i].period, a[i].activations, a[i].misses, a[i].worst_lateness, a[i].name);
+    }
+}
+
+void write_deadline_stats_to_file(void) {
+    std::string s1 = DEADLINE_STATS_FILE_PREFIX;
+    std::string s2 = std::to_string(boost::interprocess::ipcdetail::get_current_process_id());
+    std::string s3 = ".txt";
+    std::string path = "output/" + s1 + s2 + s3;
+
+    FILE* fp = fopen(path.c_str(), "w");
+    if (fp == NULL) {
+        std::cerr << "Unable to open " << path << " for writing the deadline stats." << std::endl;
+        exit(1);
+    }
+
+    // The name goes last as it may contain spaces
+    fprintf(fp, "Kind Period Activations Misses WorstLateness Name\n");
+    write_activations(fp, "task", tasks, DEADLINE_STATS_MAX_TASKS);
+    write_activations(fp, "timer", timers, DEADLINE_STATS_MAX_TIMERS);
+
+    fclose(fp);
+}
@@ -0,0 +1,25 @@
+#ifndef DEADLINE_STATS_H
+#define DEADLINE_STATS_H
+
+/* Periodic tasks with a TCB number above this one are not tracked */
+#define DEADLINE_STATS_MAX_TASKS    256
+/* Auto-reload timers tracked (the first ones to expire) */
+#define DEADLINE_STATS_MAX_TIMERS   64
+/* Characters of the task or timer name kept */
+#define DEADLINE_STATS_NAME_LEN     24
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /* Activation of a periodic task (back from xTaskDelayUntil()) or of an auto-reload timer,
+    due at the release tick and happened at the now tick */
+    void deadline_stats_task_released(unsigned long task_number, const char* name, unsigned long period, unsigned long release, unsigned long now);
+    void deadline_stats_timer_released(const void* timer, const char* name, unsigned long period, unsigned long release, unsigned long now);
+    void write_deadline_stats_to_file(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEADLINE_STATS_H */
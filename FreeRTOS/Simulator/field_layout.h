@@ -0,0 +1,29 @@
+#ifndef FIELD_LAYOUT_H
+#define FIELD_LAYOUT_H
+
+#include <stddef.h>
+
+/* define the encoding for the kinds of the fields of the kernel structures */
+enum FieldKind {
+    FIELD_KIND_POINTER,
+    FIELD_KIND_COUNTER,     /* numbers of items, lengths, indexes */
+    FIELD_KIND_FLAG,        /* states, locks, bits */
+    FIELD_KIND_LIST,        /* embedded List_t */
+    FIELD_KIND_LIST_ITEM,   /* embedded ListItem_t */
+    FIELD_KIND_VALUE        /* priorities, tick values, names, ... */
+};
+
+/* A field of a kernel structure, for the fault injector */
+typedef struct {
+    const char *name;
+    size_t offset;
+    size_t size;
+    int kind;
+} FieldLayout;
+
+/* Entry of a field layout table, computed at compile time */
+#define FIELD_LAYOUT( type, field, kind )   { #field, offsetof( type, field ), sizeof( ( ( type * ) 0 )->field ), kind }
+
+#define FIELD_LAYOUT_COUNT( table )         ( sizeof( table ) / sizeof( ( table )[ 0 ] ) )
+
+#endif /* FIELD_LAYOUT_H */
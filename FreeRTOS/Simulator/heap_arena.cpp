@@ -0,0 +1,53 @@
+#include "heap_arena.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <iostream>
+
+#include "simulator_config.h"
+#include "memory_logger.h"
+
+#include <FreeRTOS.h>
+
+#if defined HEAP_ARENA
+#include <sys/mman.h>
+
+/* Not defined by older C libraries: the kernel ignores it before Linux 4.17 and the address is just a hint */
+#ifndef MAP_FIXED_NOREPLACE
+    #define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+static void* arena_base = NULL;
+
+/*
+* The FreeRTOS heap (heap_5) is a single mmap'd region of configTOTAL_HEAP_SIZE bytes:
+* all the dynamically allocated kernel objects (and the task stacks) are in one address range.
+*/
+void heap_arena_init(void) {
+    HeapRegion_t regions[2];
+
+    arena_base = mmap((void*)HEAP_ARENA_BASE_ADDRESS, configTOTAL_HEAP_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (arena_base == MAP_FAILED) {
+        // The address is already taken: the arena is still contiguous, at another address
+        arena_base = mmap(NULL, configTOTAL_HEAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (arena_base == MAP_FAILED) {
+        std::cerr << "Unable to map the FreeRTOS heap arena." << std::endl;
+        exit(1);
+    }
+
+    regions[0].pucStartAddress = (uint8_t*)arena_base;
+    regions[0].xSizeInBytes = configTOTAL_HEAP_SIZE;
+    regions[1].pucStartAddress = NULL;
+    regions[1].xSizeInBytes = 0;
+
+    vPortDefineHeapRegions(regions);
+}
+
+void heap_arena_log(void) {
+    log_struct((char*)"HeapArena", TYPE_HEAP_ARENA, arena_base);
+    log_symbol((char*)HEAP_ARENA_SYM_BASE, (void*)&arena_base);
+}
+
+#endif
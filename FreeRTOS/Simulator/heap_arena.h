@@ -0,0 +1,21 @@
+#ifndef HEAP_ARENA_H
+#define HEAP_ARENA_H
+
+/* Address requested for the arena, so that the kernel objects have the same addresses in every run */
+#define HEAP_ARENA_BASE_ADDRESS     0x600000000000ULL
+
+/* Symbol (see log_symbol) of the arena base, read by the injector to know whether the arena is where it was in the golden run */
+#define HEAP_ARENA_SYM_BASE         "HeapArenaBase"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void heap_arena_init(void);
+    void heap_arena_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEAP_ARENA_H */
@@ -8,6 +8,7 @@
 /* Platform-dependent. */
 #if defined _WIN32
     #include <conio.h>
+    #include <process.h>
 #elif defined __unix__
     #include <unistd.h>
     #include <stdarg.h>
@@ -38,6 +39,10 @@
 #include "console.h"
 #include "memory_logger.h"
 #include "sync.h"
+#include "state_digest.h"
+#include "trigger.h"
+#include "heap_arena.h"
+#include "workload.h"
 
 /* Priorities at which the tasks are created. */
 //#define mainCHECK_TASK_PRIORITY			( configMAX_PRIORITIES - 2 )
@@ -79,6 +84,14 @@ static void prvCheckTask( void *pvParameters );
 eTaskStateGet(). */
 static void prvTestTask( void *pvParameters );
 
+#if defined TRACE_RECORDER
+/*
+ * Writes the snapshot of the kernel trace recorder to the output directory,
+ * next to the output of the run.
+ */
+static void prvSaveTraceFile( void );
+#endif
+
 /*
  * Called from the idle task hook function to demonstrate the use of
  * xTimerPendFunctionCall() as xTimerPendFunctionCall() is not demonstrated by
@@ -135,93 +148,124 @@ TaskHandle_t xTaskBlockNoti;
 
 /*-----------------------------------------------------------*/
 
-int main( void )
+#if defined SIMULATOR_AS_LIBRARY
+/* Entry point of the shared library build, called by the FaultInjector in a forked process. */
+int simulator_main( int argc, char **argv )
+#else
+int main( int argc, char **argv )
+#endif
 {
+    /* Select the tasks of the run: the build options are only the defaults. */
+    workload_init( argc, argv );
+
+    /* Handshake channel with the FaultInjector, if it spawned this run. */
+    sync_init( argc, argv );
+
+#if defined HEAP_ARENA
+    /* The heap must be defined before the first allocation. */
+    heap_arena_init();
+#endif
+
+#if defined TRACE_RECORDER
+    /* The recorder must be running before any kernel object is created. The
+    events are kept in a RAM buffer and only written to file at exit. */
+    vTraceEnable( TRC_START );
+#endif
+
     console_init();
 
     /* Start the logging for the memory data structures */
     log_data_structs_start();
 
-#if defined TASK_CHECK
-    /* Start the check task as described at the top of this file. */
-    xTaskCreate( prvCheckTask, "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, &xTaskCheck );
-
-    /* log the "Check" task handle */
-    log_struct("CheckTask", TYPE_TASK_HANDLE, xTaskCheck);
+#if defined HEAP_ARENA
+    /* log the heap, which holds all the dynamically allocated kernel objects */
+    heap_arena_log();
 #endif
 
+    if( workload_enabled( WORKLOAD_TASK_CHECK ) )
+    {
+        /* Start the check task as described at the top of this file. */
+        xTaskCreate( prvCheckTask, "Check", configMINIMAL_STACK_SIZE, NULL, workload_get_priority( WORKLOAD_TASK_CHECK, mainCHECK_TASK_PRIORITY ), &xTaskCheck );
+
+        /* log the "Check" task handle */
+        log_struct("CheckTask", TYPE_TASK_HANDLE, xTaskCheck);
+    }
+
     /* Create the standard demo tasks. */
-#if defined TASK_BLOCKING_QUEUE
-    vStartBlockingQueueTasks( mainBLOCK_Q_PRIORITY );
-#endif
-#if defined TASK_SEM_TEST
-    vStartSemaphoreTasks( mainSEM_TEST_PRIORITY );
-#endif
-#if defined TASK_POLL_QUEUE
-    vStartPolledQueueTasks( mainQUEUE_POLL_PRIORITY );
-#endif
-#if defined TASK_COUNT_SEM
-    vStartCountingSemaphoreTasks();
-#endif
-#if defined TASK_EVENT_GROUPS
-    vStartEventGroupTasks();
-#endif
-#if defined TASK_QUEUE_SPACE_AVAIL
-    xTaskCreate( prvDemoQueueSpaceFunctions, "QSpace", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xTaskQSpace );
+    if( workload_enabled( WORKLOAD_TASK_BLOCKING_QUEUE ) )
+        vStartBlockingQueueTasks( workload_get_priority( WORKLOAD_TASK_BLOCKING_QUEUE, mainBLOCK_Q_PRIORITY ) );
+    if( workload_enabled( WORKLOAD_TASK_SEM_TEST ) )
+        vStartSemaphoreTasks( workload_get_priority( WORKLOAD_TASK_SEM_TEST, mainSEM_TEST_PRIORITY ) );
+    if( workload_enabled( WORKLOAD_TASK_POLL_QUEUE ) )
+        vStartPolledQueueTasks( workload_get_priority( WORKLOAD_TASK_POLL_QUEUE, mainQUEUE_POLL_PRIORITY ) );
+    if( workload_enabled( WORKLOAD_TASK_COUNT_SEM ) )
+        vStartCountingSemaphoreTasks();
+    if( workload_enabled( WORKLOAD_TASK_EVENT_GROUPS ) )
+        vStartEventGroupTasks();
+    if( workload_enabled( WORKLOAD_TASK_QUEUE_SPACE_AVAIL ) )
+    {
+        xTaskCreate( prvDemoQueueSpaceFunctions, "QSpace", configMINIMAL_STACK_SIZE, NULL, workload_get_priority( WORKLOAD_TASK_QUEUE_SPACE_AVAIL, tskIDLE_PRIORITY ), &xTaskQSpace );
 
-    /* log the "QSpace" task handle */
-    log_struct("QSpaceTask", TYPE_TASK_HANDLE, xTaskQSpace);
-#endif
-#if defined TASK_INDEF_DELAY_SEM
-    xTaskCreate( prvPermanentlyBlockingSemaphoreTask, "BlockSem", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xTaskBlockSem);
+        /* log the "QSpace" task handle */
+        log_struct("QSpaceTask", TYPE_TASK_HANDLE, xTaskQSpace);
+    }
+    if( workload_enabled( WORKLOAD_TASK_INDEF_DELAY_SEM ) )
+    {
+        xTaskCreate( prvPermanentlyBlockingSemaphoreTask, "BlockSem", configMINIMAL_STACK_SIZE, NULL, workload_get_priority( WORKLOAD_TASK_INDEF_DELAY_SEM, tskIDLE_PRIORITY ), &xTaskBlockSem);
 
-    /* log the "BlockSem" task handle */
-    log_struct("BlockSemTask", TYPE_TASK_HANDLE, xTaskBlockSem);
-#endif
-#if defined TASK_INDEF_DELAY_NOTIF
-    xTaskCreate( prvPermanentlyBlockingNotificationTask, "BlockNoti", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xTaskBlockNoti);
+        /* log the "BlockSem" task handle */
+        log_struct("BlockSemTask", TYPE_TASK_HANDLE, xTaskBlockSem);
+    }
+    if( workload_enabled( WORKLOAD_TASK_INDEF_DELAY_NOTIF ) )
+    {
+        xTaskCreate( prvPermanentlyBlockingNotificationTask, "BlockNoti", configMINIMAL_STACK_SIZE, NULL, workload_get_priority( WORKLOAD_TASK_INDEF_DELAY_NOTIF, tskIDLE_PRIORITY ), &xTaskBlockNoti);
 
-    /* log the "BlockNoti" task handle */
-    log_struct("BlockNotiTask", TYPE_TASK_HANDLE, xTaskBlockNoti);
-#endif
+        /* log the "BlockNoti" task handle */
+        log_struct("BlockNotiTask", TYPE_TASK_HANDLE, xTaskBlockNoti);
+    }
 
-#if defined TASK_MESSAGE_BUFFER
-    vStartMessageBufferTasks( configMINIMAL_STACK_SIZE );
-#endif
-#if defined TASK_STREAM_BUFFER
-    vStartStreamBufferTasks();
-#endif
+    if( workload_enabled( WORKLOAD_TASK_MESSAGE_BUFFER ) )
+        vStartMessageBufferTasks( configMINIMAL_STACK_SIZE );
+    if( workload_enabled( WORKLOAD_TASK_STREAM_BUFFER ) )
+        vStartStreamBufferTasks();
 
     #if ( configUSE_QUEUE_SETS == 1 )
         {
-            #if defined TASK_QUEUE_SET
+            if( workload_enabled( WORKLOAD_TASK_QUEUE_SET ) )
                 vStartQueueSetTasks();
-            #endif
         }
     #endif
 
     #if ( configUSE_PREEMPTION != 0 )
         {
-            #if defined TASK_TIMER
+            if( workload_enabled( WORKLOAD_TASK_TIMER ) )
                 /* Don't expect these tasks to pass when preemption is not used. */
                 vStartTimerDemoTask( mainTIMER_TEST_PERIOD );
-            #endif          
         }
     #endif
     
-#if defined TEST_DELETE_MUTEX
-    /* Create the semaphore that will be deleted in the idle task hook.  This
-     * is done purely to test the use of vSemaphoreDelete(). */
-    xMutexToDelete = xSemaphoreCreateMutex();
+    if( workload_enabled( WORKLOAD_TEST_DELETE_MUTEX ) )
+    {
+        /* Create the semaphore that will be deleted in the idle task hook.  This
+         * is done purely to test the use of vSemaphoreDelete(). */
+        xMutexToDelete = xSemaphoreCreateMutex();
 
-    /* log the "xMutexToDelete" semaphore handle */
-    log_struct("MutexToDelete", TYPE_SEMAPHORE_HANDLE, xMutexToDelete);
-#endif
+        /* log the "xMutexToDelete" semaphore handle */
+        log_struct("MutexToDelete", TYPE_SEMAPHORE_HANDLE, xMutexToDelete);
+    }
     
     /* log internal kernel data structures*/
     log_timers_struct();
     log_tasks_struct();
 
+#if defined STATE_DIGEST
+    /* log the state digest variables written by the FaultInjector */
+    state_digest_init();
+#endif
+
+    /* log the trigger table armed by the FaultInjector */
+    trigger_init();
+
     /* End the logging for the memory data structures*/
     log_data_structs_end();
 
@@ -240,6 +284,33 @@ int main( void )
 }
 /*-----------------------------------------------------------*/
 
+#if defined TRACE_RECORDER
+static void prvSaveTraceFile( void )
+{
+    FILE *pxOutputFile;
+    char pcPath[ 100 ];
+
+    vTraceStop();
+
+    #if defined _WIN32
+        sprintf( pcPath, "output/%s%d.bin", TRACE_FILE_PREFIX, _getpid() );
+    #elif defined __unix__
+        sprintf( pcPath, "output/%s%d.bin", TRACE_FILE_PREFIX, ( int ) getpid() );
+    #endif
+
+    pxOutputFile = fopen( pcPath, "wb" );
+    if( pxOutputFile == NULL )
+    {
+        fprintf( stderr, "Unable to open %s for writing the trace.\n", pcPath );
+        exit( 1 );
+    }
+
+    fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
+    fclose( pxOutputFile );
+}
+/*-----------------------------------------------------------*/
+#endif
+
 void vSleepMS(const unsigned long ulMSToSleep) {
     #ifdef __unix__
         struct timespec ts;
@@ -366,23 +437,24 @@ void *pvAllocated;
     tasks waiting to be terminated by the idle task. */
     vSleepMS( ulMSToSleep );
 
-#if defined TASK_PEND_FUNC_CALL
-    /* Demonstrate the use of xTimerPendFunctionCall(), which is not
-    demonstrated by any of the standard demo tasks. */
-    prvDemonstratePendingFunctionCall();
-#endif
+    if( workload_enabled( WORKLOAD_TASK_PEND_FUNC_CALL ) )
+    {
+        /* Demonstrate the use of xTimerPendFunctionCall(), which is not
+        demonstrated by any of the standard demo tasks. */
+        prvDemonstratePendingFunctionCall();
+    }
 
-#if defined TASK_TIMER_QUERY
-    /* Demonstrate the use of functions that query information about a software
-    timer. */
-    prvDemonstrateTimerQueryFunctions();
-#endif
+    if( workload_enabled( WORKLOAD_TASK_TIMER_QUERY ) )
+    {
+        /* Demonstrate the use of functions that query information about a software
+        timer. */
+        prvDemonstrateTimerQueryFunctions();
+    }
 
-#if defined TEST_DELETE_MUTEX
     /* If xMutexToDelete has not already been deleted, then delete it now.
     This is done purely to demonstrate the use of, and test, the
     vSemaphoreDelete() macro.  Care must be taken not to delete a semaphore
-    that has tasks blocked on it. */
+    that has tasks blocked on it. It is only created by TEST_DELETE_MUTEX. */
     if( xMutexToDelete != NULL )
     {
         /* For test purposes, add the mutex to the registry, then remove it
@@ -398,7 +470,6 @@ void *pvAllocated;
         vSemaphoreDelete( xMutexToDelete );
         xMutexToDelete = NULL;
     }
-#endif
 
     /* Exercise heap_5 a bit.  The malloc failed hook will trap failed
     allocations so there is no need to test here. */
@@ -412,10 +483,10 @@ void vApplicationTickHook( void )
 {
 TaskHandle_t xTimerTask;
 BaseType_t xTimerDemoAlive;
-#if defined TIMER_PERIODIC_ISR_TESTS
     /* Call the periodic timer test, which tests the timer API functions that
     can be called from an ISR. */
     #if( configUSE_PREEMPTION != 0 )
+    if( workload_enabled( WORKLOAD_TIMER_PERIODIC_ISR_TESTS ) )
     {
 		/* Only created when preemption is used. */
         portENTER_CRITICAL();
@@ -427,51 +498,53 @@ BaseType_t xTimerDemoAlive;
         }
 	}
     #endif
-#endif
 
-#if defined QUEUE_OVERWRITE_PERIODIC_ISR
-    /* Call the periodic queue overwrite from ISR demo. */
-    vQueueOverwritePeriodicISRDemo();
-#endif
+    if( workload_enabled( WORKLOAD_QUEUE_OVERWRITE_PERIODIC_ISR ) )
+    {
+        /* Call the periodic queue overwrite from ISR demo. */
+        vQueueOverwritePeriodicISRDemo();
+    }
 
     #if( configUSE_QUEUE_SETS == 1 ) /* Remove the tests if queue sets are not defined. */
     {
 		/* Write to a queue that is in use as part of the queue set demo to
 		demonstrate using queue sets from an ISR. */
-        #if defined QUEUE_SET_ACCESS_ISR
+        if( workload_enabled( WORKLOAD_QUEUE_SET_ACCESS_ISR ) )
 		    vQueueSetAccessQueueSetFromISR();
-        #endif
-        #if defined QUEUE_SET_ACCESS_POLL_ISR
+        if( workload_enabled( WORKLOAD_QUEUE_SET_ACCESS_POLL_ISR ) )
 		    vQueueSetPollingInterruptAccess();
-        #endif
 	}
     #endif
     
-#if defined EVENT_GROUP_ISR
-    /* Exercise event groups from interrupts. */
-    vPeriodicEventGroupsProcessing();
-#endif
+    if( workload_enabled( WORKLOAD_EVENT_GROUP_ISR ) )
+    {
+        /* Exercise event groups from interrupts. */
+        vPeriodicEventGroupsProcessing();
+    }
 
-#if defined SEM_TEST_ISR
-    /* Exercise giving mutexes from an interrupt. */
-    vInterruptSemaphorePeriodicTest();
-#endif
+    if( workload_enabled( WORKLOAD_SEM_TEST_ISR ) )
+    {
+        /* Exercise giving mutexes from an interrupt. */
+        vInterruptSemaphorePeriodicTest();
+    }
     
-#if defined NOTIFY_TASK_ISR
-    /* Exercise using task notifications from an interrupt. */
-    xNotifyTaskFromISR();
-#endif
+    if( workload_enabled( WORKLOAD_NOTIFY_TASK_ISR ) )
+    {
+        /* Exercise using task notifications from an interrupt. */
+        xNotifyTaskFromISR();
+    }
 
 #if defined _WIN32 && defined TASK_TASK_NOTIFY_ARRAY
     /* Exercise using task notifications (notification array) from an interrupt. */
     xNotifyArrayTaskFromISR();
 #endif
 
-#if defined STREAM_BUFFER_SEND_ISR
-    /* Writes a string to a string buffer four bytes at a time to demonstrate
-    a stream being sent from an interrupt to a task. */
-    vBasicStreamBufferSendFromISR();
-#endif
+    if( workload_enabled( WORKLOAD_STREAM_BUFFER_SEND_ISR ) )
+    {
+        /* Writes a string to a string buffer four bytes at a time to demonstrate
+        a stream being sent from an interrupt to a task. */
+        vBasicStreamBufferSendFromISR();
+    }
 
     /* For code coverage purposes. */
     xTimerTask = xTimerGetTimerDaemonTaskHandle();
@@ -532,7 +605,7 @@ the stack and so not exists after this function exits. */
 static void prvCheckTask( void * pvParameters )
 {
     TickType_t xNextWakeTime;
-    const TickType_t xCycleFrequency = pdMS_TO_TICKS( 10000UL );
+    const TickType_t xCycleFrequency = ( TickType_t ) workload_get_period_ticks();
     int count = 0;
     //HeapStats_t xHeapStats;
 
@@ -552,32 +625,26 @@ static void prvCheckTask( void * pvParameters )
         /* Check the standard demo tasks are running without error. */
 #if ( configUSE_PREEMPTION != 0 )
         {
-                #if defined TASK_TIMER
-                    /* These tasks are only created when preemption is used. */
-                    if( xAreTimerDemoTasksAlive() == pdTRUE && xAreTimerDemoTasksStillRunning( xCycleFrequency ) != pdTRUE )
-                    {
-                        pcStatusMessage = "Error: TimerDemo";
-                        xErrorCount++;
-                    }
-                #endif
+                /* These tasks are only created when preemption is used. */
+                if( workload_enabled( WORKLOAD_TASK_TIMER ) && xAreTimerDemoTasksAlive() == pdTRUE && xAreTimerDemoTasksStillRunning( xCycleFrequency ) != pdTRUE )
+                {
+                    pcStatusMessage = "Error: TimerDemo";
+                    xErrorCount++;
+                }
             }
 #endif
 
-#if defined TASK_STREAM_BUFFER
-        if( xAreStreamBufferTasksStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_STREAM_BUFFER ) && xAreStreamBufferTasksStillRunning() != pdTRUE )
         {
             pcStatusMessage = "Error:  StreamBuffer";
             xErrorCount++;
         }
-#endif
-#if defined TASK_MESSAGE_BUFFER
-        if( xAreMessageBuffersAlive() == pdTRUE && xAreMessageBufferTasksStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_MESSAGE_BUFFER ) && xAreMessageBuffersAlive() == pdTRUE && xAreMessageBufferTasksStillRunning() != pdTRUE )
         {
             console_print("Alive: %d, Still running: %d", xAreMessageBuffersAlive(), xAreMessageBufferTasksStillRunning());
             pcStatusMessage = "Error:  MessageBuffer";
             xErrorCount++;
         }
-#endif
 #if defined TASK_TASK_NOTIFY
         if( xAreTaskNotificationTasksStillRunning() != pdTRUE )
         {
@@ -599,13 +666,11 @@ static void prvCheckTask( void * pvParameters )
             xErrorCount++;
         }
 #endif
-#if defined TASK_EVENT_GROUPS
-        if( xAreEventGroupTasksStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_EVENT_GROUPS ) && xAreEventGroupTasksStillRunning() != pdTRUE )
         {
             pcStatusMessage = "Error: EventGroup";
             xErrorCount++;
         }
-#endif
 #if defined TASK_INTEGER
         if( xAreIntegerMathsTaskStillRunning() != pdTRUE )
         {
@@ -627,27 +692,21 @@ static void prvCheckTask( void * pvParameters )
             xErrorCount++;
         }
 #endif
-#if defined TASK_BLOCKING_QUEUE
-        if( xAreBlockingQueuesStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_BLOCKING_QUEUE ) && xAreBlockingQueuesStillRunning() != pdTRUE )
         {
             pcStatusMessage = "Error: BlockQueue";
             xErrorCount++;
         }
-#endif
-#if defined TASK_SEM_TEST
-        if( xAreSemaphoreTasksStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_SEM_TEST ) && xAreSemaphoreTasksStillRunning() != pdTRUE )
         {
             pcStatusMessage = "Error: SemTest";
             xErrorCount++;
         }
-#endif
-#if defined TASK_POLL_QUEUE
-        if( xArePollingQueuesAlive() == pdTRUE && xArePollingQueuesStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_POLL_QUEUE ) && xArePollingQueuesAlive() == pdTRUE && xArePollingQueuesStillRunning() != pdTRUE )
         {
             pcStatusMessage = "Error: PollQueue";
             xErrorCount++;
         }
-#endif
 #if defined TASK_FLOP
         if( xAreMathsTaskStillRunning() != pdPASS )
         {
@@ -662,13 +721,11 @@ static void prvCheckTask( void * pvParameters )
             xErrorCount++;
         }
 #endif
-#if defined TASK_COUNT_SEM
-        if( xAreCountingSemaphoreTasksStillRunning() != pdTRUE )
+        if( workload_enabled( WORKLOAD_TASK_COUNT_SEM ) && xAreCountingSemaphoreTasksStillRunning() != pdTRUE )
         {
             pcStatusMessage = "Error: CountSem";
             xErrorCount++;
         }
-#endif
 #if defined TASK_DEATH
         if( xIsCreateTaskStillRunning() != pdTRUE )
         {
@@ -704,13 +761,11 @@ static void prvCheckTask( void * pvParameters )
             xErrorCount++;
         }
 #endif
-#if defined STREAM_BUFFER_SEND_ISR
-        if( xIsInterruptStreamBufferDemoStillRunning() != pdPASS )
+        if( workload_enabled( WORKLOAD_STREAM_BUFFER_SEND_ISR ) && xIsInterruptStreamBufferDemoStillRunning() != pdPASS )
         {
             pcStatusMessage = "Error: Stream buffer interrupt";
             xErrorCount++;
         }
-#endif
 #if defined TASK_MESSAGE_BUFF_AMP
         if( xAreMessageBufferAMPTasksStillRunning() != pdPASS )
         {
@@ -720,13 +775,11 @@ static void prvCheckTask( void * pvParameters )
 #endif
 
 #if ( configUSE_QUEUE_SETS == 1 )
-        #if defined TASK_QUEUE_SET
-            if( xAreQueueSetTasksStillRunning() != pdPASS )
-            {
-                pcStatusMessage = "Error: Queue set";
-                xErrorCount++;
-            }
-        #endif
+        if( workload_enabled( WORKLOAD_TASK_QUEUE_SET ) && xAreQueueSetTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Queue set";
+            xErrorCount++;
+        }
         #if defined TASK_QUEUE_SET_POLL
             if( xAreQueueSetPollTasksStillRunning() != pdPASS )
             {
@@ -763,8 +816,26 @@ static void prvCheckTask( void * pvParameters )
         /* Reset the error condition */
         pcStatusMessage = "No errors";
 
-        if (count == 3) {
+#if defined STATE_DIGEST
+        /* Stop here if an injected run is back to the golden state */
+        state_digest_check_cycle();
+#endif
+
+        /* Forward progress, which keeps an injected run from being killed as hung */
+        signal_progress( ( uint64_t ) count );
+
+        if (count == workload_get_cycles()) {
             write_output_to_file();
+            write_task_stats_to_file();
+            write_deadline_stats_to_file();
+            write_trigger_counts_to_file();
+#if defined STATE_DIGEST
+            write_state_digests_to_file();
+#endif
+#if defined TRACE_RECORDER
+            prvSaveTraceFile();
+#endif
+            signal_run_done(0);
             exit(0);
             vPortEndScheduler();
         }
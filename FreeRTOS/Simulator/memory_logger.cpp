@@ -2,6 +2,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
 
 #include <boost/interprocess/detail/os_thread_functions.hpp>
 #include "simulator_config.h"
@@ -9,9 +12,31 @@
 FILE *structures_log_fp;
 int nextID = 0;
 
+// The logged structures, indexed by ID, for the simulator itself (e.g. the state digest)
+std::vector<std::pair<int, void*>> logged_structs;
+std::vector<std::string> logged_names;
+
 void log_struct(char *name, int type, void *address) {
-    if (structures_log_fp != NULL)
+    if (structures_log_fp != NULL) {
         fprintf(structures_log_fp, "%d %s %d %p\n", nextID++, name, type, address);
+        logged_structs.push_back(std::make_pair(type, address));
+        logged_names.push_back(name);
+    }
+}
+
+int get_logged_structs_count() {
+    return (int)logged_structs.size();
+}
+
+void get_logged_struct(int index, int *type, void **address) {
+    *type = logged_structs[index].first;
+    *address = logged_structs[index].second;
+}
+
+/* Kernel variables which are not injected but read by the injector (e.g. the tick count) */
+void log_symbol(char *name, void *address) {
+    if (structures_log_fp != NULL)
+        fprintf(structures_log_fp, "# %s %p\n", name, address);
 }
 
 void log_data_structs_start() {
@@ -28,6 +53,15 @@ void log_data_structs_start() {
 }
 
 void log_data_structs_end() {
+    // The stack of every logged task, reached through its TCB (logged last, so the IDs of the other structures don't change)
+    size_t count = logged_structs.size();
+    for (size_t i = 0; i < count; i++) {
+        if (logged_structs[i].first == TYPE_TASK_HANDLE && logged_structs[i].second != NULL) {
+            std::string name = logged_names[i] + "_Stack";
+            log_struct(&name[0], TYPE_TASK_STACK, logged_structs[i].second);
+        }
+    }
+
     fclose(structures_log_fp);
 }
 
@@ -56,6 +90,10 @@ char * get_data_struct_type(int dst) {
         return "Static Stack";
     case TYPE_LIST:
         return "List";
+    case TYPE_HEAP_ARENA:
+        return "Heap Arena";
+    case TYPE_TASK_STACK:
+        return "Task Stack";
     default:
         return "Invalid type";
     }
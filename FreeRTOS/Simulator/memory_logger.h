@@ -13,7 +13,9 @@ enum DataStructureType {
     TYPE_STREAM_BUFFER_HANDLE,
     TYPE_QUEUE_SET_HANDLE,
     TYPE_STATIC_STACK,
-    TYPE_LIST
+    TYPE_LIST,
+    TYPE_HEAP_ARENA,
+    TYPE_TASK_STACK
 };
 
 
@@ -22,6 +24,9 @@ extern "C" {
 #endif
 
     void log_struct(char *name, int type, void *address);
+    void log_symbol(char *name, void *address);
+    int get_logged_structs_count();
+    void get_logged_struct(int index, int *type, void **address);
     void log_data_structs_start();
     void log_data_structs_end();
     char * get_data_struct_type(int dst);
@@ -0,0 +1,226 @@
+#include "state_digest.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/detail/os_thread_functions.hpp>
+#include "simulator_config.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <timers.h>
+#include <event_groups.h>
+#include <stream_buffer.h>
+#include "memory_logger.h"
+#include "console.h"
+#include "sync.h"
+#include "task_stats.h"
+
+#define PRIME64_1   0x9E3779B185EBCA87ULL
+#define PRIME64_2   0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3   0x165667B19E3779F9ULL
+#define PRIME64_4   0x85EBCA77C2B2AE63ULL
+#define PRIME64_5   0x27D4EB2F165667C5ULL
+
+/* Written by the injector (see the symbols in state_digest.h) */
+volatile uint64_t golden_digests[STATE_DIGEST_MAX_CYCLES];
+volatile uint32_t golden_digest_count = 0;
+volatile uint32_t injection_done = 0;
+
+std::vector<uint64_t> state_digests;
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val) {
+    acc ^= xxh64_round(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+// XXH64: four independent lanes over 32-byte blocks, which the compiler can vectorize
+static uint64_t xxh64(const void* input, size_t len, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)input;
+    const unsigned char* end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+
+        do {
+            v1 = xxh64_round(v1, read64(p));
+            v2 = xxh64_round(v2, read64(p + 8));
+            v3 = xxh64_round(v3, read64(p + 16));
+            v4 = xxh64_round(v4, read64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64_merge_round(h, v1);
+        h = xxh64_merge_round(h, v2);
+        h = xxh64_merge_round(h, v3);
+        h = xxh64_merge_round(h, v4);
+    }
+    else {
+        h = seed + PRIME64_5;
+    }
+
+    h += (uint64_t)len;
+
+    while (p + 8 <= end) {
+        h ^= xxh64_round(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+// Same sizes used by the injector (see FreeRTOSInterface.c)
+static size_t get_digest_size(int type) {
+    switch (type)
+    {
+    case TYPE_TASK_HANDLE:
+        return getTCB_FixedSize();
+    case TYPE_QUEUE_HANDLE:
+    case TYPE_SEMAPHORE_HANDLE:
+    case TYPE_COUNT_SEMAPHORE:
+        return getQueue_FixedSize();
+    case TYPE_TIMER_HANDLE:
+        return getTimer_FixedSize();
+    case TYPE_EVENT_GROUP_HANDLE:
+        return getEventGroup_FixedSize();
+    case TYPE_MESSAGE_BUFFER_HANDLE:
+    case TYPE_STREAM_BUFFER_HANDLE:
+        return getStreamBuffer_FixedSize();
+    case TYPE_QUEUE_SET_HANDLE:
+        return sizeof(StaticQueue_t);
+    case TYPE_LIST:
+        return getList_FixedSize();
+    default:
+        // Stacks are the stacks of the pthreads: their content is not reproducible
+        // (the heap arena holds the stacks too, its kernel objects are hashed one by one)
+        return 0;
+    }
+}
+
+static uint64_t compute_state_digest(void) {
+    uint64_t digest = 0;
+    std::vector<unsigned char> tcb(getTCB_FixedSize());
+    size_t run_time_offset = getTCB_RunTimeCounterOffset();
+
+    taskENTER_CRITICAL();
+    {
+        for (int i = 0; i < get_logged_structs_count(); i++) {
+            int type;
+            void* address;
+            size_t size;
+
+            get_logged_struct(i, &type, &address);
+            size = get_digest_size(type);
+            if (address == NULL || size == 0)
+                continue;
+
+            if (type == TYPE_TASK_HANDLE) {
+                // The run time counter changes between runs even if the task state is the same
+                memcpy(tcb.data(), address, size);
+                if (run_time_offset + sizeof(configRUN_TIME_COUNTER_TYPE) <= size)
+                    memset(tcb.data() + run_time_offset, 0, sizeof(configRUN_TIME_COUNTER_TYPE));
+                digest = xxh64(tcb.data(), size, digest);
+            }
+            else {
+                digest = xxh64(address, size, digest);
+            }
+        }
+
+        // All the ready lists (only the first one is logged)
+        digest = xxh64(getReadyTasksLists(), getReadyTasksLists_Size(), digest);
+    }
+    taskEXIT_CRITICAL();
+
+    return digest;
+}
+
+void state_digest_init(void) {
+    log_symbol((char*)STATE_DIGEST_SYM_GOLDEN, (void*)golden_digests);
+    log_symbol((char*)STATE_DIGEST_SYM_GOLDEN_COUNT, (void*)&golden_digest_count);
+    log_symbol((char*)STATE_DIGEST_SYM_INJECTED, (void*)&injection_done);
+}
+
+void state_digest_check_cycle(void) {
+    uint64_t digest = compute_state_digest();
+    size_t cycle = state_digests.size();
+
+    state_digests.push_back(digest);
+
+    // After the injection, the same state of the golden run at the same cycle means the fault has been masked
+    if (injection_done && cycle < golden_digest_count && golden_digests[cycle] == digest) {
+        write_output_to_file();
+        write_task_stats_to_file();
+        write_deadline_stats_to_file();
+        write_trigger_counts_to_file();
+        write_state_digests_to_file();
+        signal_run_done(STATE_DIGEST_MASKED_EXIT_CODE);
+        exit(STATE_DIGEST_MASKED_EXIT_CODE);
+    }
+}
+
+void write_state_digests_to_file(void) {
+    std::string s1 = STATE_DIGEST_FILE_PREFIX;
+    std::string s2 = std::to_string(boost::interprocess::ipcdetail::get_current_process_id());
+    std::string s3 = ".txt";
+    std::string path = "output/" + s1 + s2 + s3;
+
+    FILE* fp = fopen(path.c_str(), "w");
+    if (fp == NULL) {
+        std::cerr << "Unable to open " << path << " for writing the state digests." << std::endl;
+        exit(1);
+    }
+
+    for (auto d : state_digests)
+        fprintf(fp, "%016llx\n", (unsigned long long)d);
+
+    fclose(fp);
+}
@@ -0,0 +1,27 @@
+#ifndef STATE_DIGEST_H
+#define STATE_DIGEST_H
+
+/* Check cycles for which the golden digests can be loaded in the simulator */
+#define STATE_DIGEST_MAX_CYCLES         64
+
+/* Exit code of an injected run stopped because its state matched the golden one again */
+#define STATE_DIGEST_MASKED_EXIT_CODE   3
+
+/* Symbols (see log_symbol) written by the injector before starting and after injecting */
+#define STATE_DIGEST_SYM_GOLDEN         "GoldenDigests"
+#define STATE_DIGEST_SYM_GOLDEN_COUNT   "GoldenDigestCount"
+#define STATE_DIGEST_SYM_INJECTED       "InjectionDone"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void state_digest_init(void);
+    void state_digest_check_cycle(void);
+    void write_state_digests_to_file(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATE_DIGEST_H */
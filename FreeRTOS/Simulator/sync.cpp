@@ -3,11 +3,20 @@
 #include <iostream>
 #include <string>
 
+#include "memory_logger.h"
+
+#if defined _WIN32
 #include <boost/interprocess/detail/os_thread_functions.hpp>
 #include <boost/interprocess/sync/named_semaphore.hpp>
 
 namespace bi = boost::interprocess;
 
+void sync_init(int argc, char **argv) {
+	// The handshake goes through named semaphores
+	(void)argc;
+	(void)argv;
+}
+
 void signal_memory_log_finished() {
 	std::string pid = std::to_string(boost::interprocess::ipcdetail::get_current_process_id());
 	std::string sem_name = "binary_sem_log_struct_" + pid + "_1";
@@ -20,4 +29,109 @@ void wait_before_start() {
 	std::string sem_name = "binary_sem_log_struct_" + pid + "_2";
 	bi::named_semaphore s(bi::open_or_create, sem_name.c_str(), 0);
 	s.wait();
-}
\ No newline at end of file
+}
+
+void signal_run_done(int exit_code) {
+	// The injector only sees the exit code of the process
+	(void)exit_code;
+}
+
+void signal_progress(uint64_t cycles) {
+	// The injector only sees the process running
+	(void)cycles;
+}
+
+void wait_trigger_resume(uint64_t occurrence) {
+	// The injector doesn't arm the triggers without the handshake pipes
+	(void)occurrence;
+}
+#else
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+
+static int sync_read_fd = -1;
+static int sync_write_fd = -1;
+
+void sync_init(int argc, char **argv) {
+	for (int i = 1; i < argc - 1; i++) {
+		if (strcmp(argv[i], SYNC_FDS_ARG) == 0 && sscanf(argv[i + 1], "%d,%d", &sync_read_fd, &sync_write_fd) != 2) {
+			std::cerr << "Invalid " << SYNC_FDS_ARG << " argument: " << argv[i + 1] << std::endl;
+			exit(1);
+		}
+	}
+}
+
+static void sync_send(uint32_t event, uint64_t payload) {
+	SyncMessage msg = { event, 0, payload };
+
+	if (sync_write_fd == -1)
+		return;
+	// Smaller than PIPE_BUF: written at once
+	while (write(sync_write_fd, &msg, sizeof(msg)) == -1 && errno == EINTR);
+}
+
+void signal_memory_log_finished() {
+	sync_send(SYNC_EVENT_READY, (uint64_t)get_logged_structs_count());
+}
+
+void wait_before_start() {
+	SyncMessage msg;
+	ssize_t n;
+
+	if (sync_read_fd == -1)
+		return;
+
+	do {
+		n = read(sync_read_fd, &msg, sizeof(msg));
+	} while (n == -1 && errno == EINTR);
+
+	// The injector is gone: there is no one to run for
+	if (n != (ssize_t)sizeof(msg) || msg.event != SYNC_EVENT_START) {
+		std::cerr << "The fault injector closed the handshake before starting the simulator." << std::endl;
+		exit(1);
+	}
+	// Kept open for the resume after a trigger (see wait_trigger_resume)
+}
+
+void signal_run_done(int exit_code) {
+	sync_send(SYNC_EVENT_DONE, (uint64_t)exit_code);
+}
+
+/* The injector keeps reading the pipe while the simulator runs, so it never fills up */
+void signal_progress(uint64_t cycles) {
+	sync_send(SYNC_EVENT_PROGRESS, cycles);
+}
+
+/*
+* Called at the armed hook: the kernel stops there while the injector reads and writes its memory.
+* The tick is held pending by blocking the signals of the running thread (the other threads of the
+* POSIX port block them all), and no other task runs until the injector resumes the simulator.
+*/
+void wait_trigger_resume(uint64_t occurrence) {
+	SyncMessage msg;
+	ssize_t n;
+	sigset_t all_signals, previous;
+
+	if (sync_read_fd == -1)
+		return;
+
+	sigfillset(&all_signals);
+	pthread_sigmask(SIG_BLOCK, &all_signals, &previous);
+
+	sync_send(SYNC_EVENT_TRIGGER, occurrence);
+	do {
+		n = read(sync_read_fd, &msg, sizeof(msg));
+	} while (n == -1 && errno == EINTR);
+
+	// Resumed, or the injector is gone (its end closed): either way the run goes on
+	close(sync_read_fd);
+	sync_read_fd = -1;
+
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+#endif
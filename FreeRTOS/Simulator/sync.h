@@ -3,16 +3,45 @@
 #ifndef SYNC_H
 	#define SYNC_H
 
+	#include <stdint.h>
+
+	/*
+	* Handshake with the FaultInjector. On POSIX hosts it goes over a pipe pair inherited
+	* from the injector, whose simulator ends are passed with this argument
+	* ("--sync <read fd>,<write fd>"): no kernel object outlives the two processes.
+	* Without it the simulator runs standalone and does not wait to start.
+	*/
+	#define SYNC_FDS_ARG	"--sync"
+
+	/* Events of the handshake, each one with a payload */
+	enum SyncEvent {
+		SYNC_EVENT_READY = 1,	/* simulator -> injector, the data structures are logged (payload: count) */
+		SYNC_EVENT_START,		/* injector -> simulator, start the scheduler (payload: unused) */
+		SYNC_EVENT_DONE,		/* simulator -> injector, the run is over (payload: exit code) */
+		SYNC_EVENT_PROGRESS,	/* simulator -> injector, a check cycle is over (payload: cycles done) */
+		SYNC_EVENT_TRIGGER,		/* simulator -> injector, the armed hook is reached (payload: occurrence) */
+		SYNC_EVENT_RESUME		/* injector -> simulator, the fault is injected (payload: unused) */
+	};
+
+	typedef struct {
+		uint32_t event;
+		uint32_t reserved;
+		uint64_t payload;
+	} SyncMessage;
 
 	#if defined __cplusplus
 	extern "C" {
 	#endif
 
+		void sync_init(int argc, char **argv);
 		void signal_memory_log_finished();
 		void wait_before_start();
+		void signal_run_done(int exit_code);
+		void signal_progress(uint64_t cycles);
+		void wait_trigger_resume(uint64_t occurrence);
 
 
 	#if defined __cplusplus
 	}
 	#endif
-#endif /* SYNC_H */
\ No newline at end of file
+#endif /* SYNC_H */
@@ -0,0 +1,87 @@
+#include "task_stats.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined _WIN32
+    #include <windows.h>
+#elif defined __unix__
+    #include <time.h>
+#endif
+
+#include <boost/interprocess/detail/os_thread_functions.hpp>
+#include "simulator_config.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+static unsigned long long start_us = 0;
+static unsigned long switch_counts[TASK_STATS_MAX_TASKS];
+
+static unsigned long long now_us(void) {
+#if defined _WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (unsigned long long)(counter.QuadPart / (frequency.QuadPart / 1000000));
+#elif defined __unix__
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return (unsigned long long)t.tv_sec * 1000000ULL + (unsigned long long)t.tv_nsec / 1000ULL;
+#endif
+}
+
+void task_stats_init(void) {
+    start_us = now_us();
+}
+
+unsigned long task_stats_get_run_time_counter(void) {
+    // The kernel only uses differences between two readings, so wrapping around is fine
+    return (unsigned long)(now_us() - start_us);
+}
+
+void task_stats_switched_in(unsigned long task_number) {
+    // Called from the scheduler (with the kernel lock held): keep it minimal
+    if (task_number < TASK_STATS_MAX_TASKS)
+        switch_counts[task_number]++;
+}
+
+void write_task_stats_to_file(void) {
+    std::string s1 = TASK_STATS_FILE_PREFIX;
+    std::string s2 = std::to_string(boost::interprocess::ipcdetail::get_current_process_id());
+    std::string s3 = ".txt";
+    std::string path = "output/" + s1 + s2 + s3;
+
+    std::vector<TaskStatus_t> tasks(uxTaskGetNumberOfTasks());
+    configRUN_TIME_COUNTER_TYPE total_run_time;
+    UBaseType_t n = uxTaskGetSystemState(tasks.data(), tasks.size(), &total_run_time);
+
+    FILE* fp = fopen(path.c_str(), "w");
+    if (fp == NULL) {
+        std::cerr << "Unable to open " << path << " for writing the task stats." << std::endl;
+        exit(1);
+    }
+
+    // The name goes last as it may contain spaces
+    fprintf(fp, "Number RunTimeUs Switches StackHighWaterMark Name\n");
+    fprintf(fp, "%lu\n", (unsigned long)total_run_time);
+    for (UBaseType_t i = 0; i < n; i++) {
+        unsigned long number = (unsigned long)tasks[i].xTaskNumber;
+        fprintf(fp, "%lu %lu %lu %lu %s\n",
+            number,
+            (unsigned long)tasks[i].ulRunTimeCounter,
+            number < TASK_STATS_MAX_TASKS ? switch_counts[number] : 0UL,
+            (unsigned long)tasks[i].usStackHighWaterMark,
+            tasks[i].pcTaskName);
+    }
+
+    fclose(fp);
+}
@@ -0,0 +1,20 @@
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+/* Tasks with a TCB number above this one are not counted in the switch statistics */
+#define TASK_STATS_MAX_TASKS    512
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void task_stats_init(void);
+    unsigned long task_stats_get_run_time_counter(void);
+    void task_stats_switched_in(unsigned long task_number);
+    void write_task_stats_to_file(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TASK_STATS_H */
@@ -0,0 +1,69 @@
+#include "trigger.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+
+#include <boost/interprocess/detail/os_thread_functions.hpp>
+#include "simulator_config.h"
+#include "memory_logger.h"
+#include "sync.h"
+
+static TriggerTable trigger_table;
+
+static const char* hook_names[TRIGGER_HOOK_COUNT] = {
+    "none",
+    "task_switched_in",
+    "queue_send",
+    "queue_receive",
+    "timer_command_received",
+    "task_increment_tick"
+};
+
+void trigger_init(void) {
+    log_symbol((char*)TRIGGER_SYM_TABLE, (void*)&trigger_table);
+}
+
+void trigger_hit(uint32_t hook) {
+    // Hooks are called by the running task or by the tick handler on its thread: one at a time
+    uint64_t occurrence = ++trigger_table.counts[hook];
+
+    if (trigger_table.armed_hook == hook && trigger_table.armed_occurrence == occurrence) {
+        trigger_table.armed_hook = TRIGGER_HOOK_NONE;
+        wait_trigger_resume(occurrence);
+    }
+}
+
+void write_trigger_counts_to_file(void) {
+    std::string s1 = TRIGGER_COUNTS_FILE_PREFIX;
+    std::string s2 = std::to_string(boost::interprocess::ipcdetail::get_current_process_id());
+    std::string s3 = ".txt";
+    std::string path = "output/" + s1 + s2 + s3;
+
+    FILE* fp = fopen(path.c_str(), "w");
+    if (fp == NULL) {
+        std::cerr << "Unable to open " << path << " for writing the trigger counts." << std::endl;
+        exit(1);
+    }
+
+    fprintf(fp, "Hook Count\n");
+    for (int hook = TRIGGER_HOOK_NONE + 1; hook < TRIGGER_HOOK_COUNT; hook++)
+        fprintf(fp, "%s %llu\n", hook_names[hook], (unsigned long long)trigger_table.counts[hook]);
+
+    fclose(fp);
+}
+
+const char* get_trigger_hook_name(int hook) {
+    if (hook < TRIGGER_HOOK_NONE || hook >= TRIGGER_HOOK_COUNT)
+        return "invalid";
+    return hook_names[hook];
+}
+
+int get_trigger_hook(const char* name) {
+    for (int hook = TRIGGER_HOOK_NONE + 1; hook < TRIGGER_HOOK_COUNT; hook++) {
+        if (strcmp(name, hook_names[hook]) == 0)
+            return hook;
+    }
+    return TRIGGER_HOOK_NONE;
+}
@@ -0,0 +1,48 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdint.h>
+
+/* Kernel trace hooks at which an injection can be triggered */
+enum TriggerHook {
+    TRIGGER_HOOK_NONE,
+    TRIGGER_HOOK_TASK_SWITCHED_IN,
+    TRIGGER_HOOK_QUEUE_SEND,
+    TRIGGER_HOOK_QUEUE_RECEIVE,
+    TRIGGER_HOOK_TIMER_COMMAND_RECEIVED,
+    TRIGGER_HOOK_TASK_INCREMENT_TICK,
+    TRIGGER_HOOK_COUNT
+};
+
+/* Symbol (see log_symbol) of the trigger table, armed by the injector before starting */
+#define TRIGGER_SYM_TABLE       "TriggerTable"
+
+/*
+* Shared with the injector: the occurrences of every hook so far, and the hook armed for the injection.
+* When the armed hook reaches its occurrence, the table is disarmed and the simulator stops right there
+* until the injector has injected (see wait_trigger_resume).
+*/
+typedef struct {
+    uint32_t armed_hook;
+    uint32_t reserved;
+    uint64_t armed_occurrence;
+    uint64_t counts[TRIGGER_HOOK_COUNT];
+} TriggerTable;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void trigger_init(void);
+    void trigger_hit(uint32_t hook);
+    void write_trigger_counts_to_file(void);
+
+    /* Name of a hook, and the hook of a name (TRIGGER_HOOK_NONE if unknown) */
+    const char* get_trigger_hook_name(int hook);
+    int get_trigger_hook(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRIGGER_H */
@@ -0,0 +1,283 @@
+#include "workload.h"
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "simulator_config.h"
+
+typedef struct {
+    const char* name;
+    bool enabled;
+    bool priority_set;
+    unsigned long priority;
+} WorkloadEntry;
+
+#if defined TASK_CHECK
+    #define DEFAULT_TASK_CHECK  true
+#else
+    #define DEFAULT_TASK_CHECK  false
+#endif
+#if defined TASK_BLOCKING_QUEUE
+    #define DEFAULT_TASK_BLOCKING_QUEUE     true
+#else
+    #define DEFAULT_TASK_BLOCKING_QUEUE     false
+#endif
+#if defined TASK_SEM_TEST
+    #define DEFAULT_TASK_SEM_TEST   true
+#else
+    #define DEFAULT_TASK_SEM_TEST   false
+#endif
+#if defined TASK_POLL_QUEUE
+    #define DEFAULT_TASK_POLL_QUEUE     true
+#else
+    #define DEFAULT_TASK_POLL_QUEUE     false
+#endif
+#if defined TASK_COUNT_SEM
+    #define DEFAULT_TASK_COUNT_SEM  true
+#else
+    #define DEFAULT_TASK_COUNT_SEM  false
+#endif
+#if defined TASK_EVENT_GROUPS
+    #define DEFAULT_TASK_EVENT_GROUPS   true
+#else
+    #define DEFAULT_TASK_EVENT_GROUPS   false
+#endif
+#if defined TASK_QUEUE_SPACE_AVAIL
+    #define DEFAULT_TASK_QUEUE_SPACE_AVAIL  true
+#else
+    #define DEFAULT_TASK_QUEUE_SPACE_AVAIL  false
+#endif
+#if defined TASK_INDEF_DELAY_SEM
+    #define DEFAULT_TASK_INDEF_DELAY_SEM    true
+#else
+    #define DEFAULT_TASK_INDEF_DELAY_SEM    false
+#endif
+#if defined TASK_INDEF_DELAY_NOTIF
+    #define DEFAULT_TASK_INDEF_DELAY_NOTIF  true
+#else
+    #define DEFAULT_TASK_INDEF_DELAY_NOTIF  false
+#endif
+#if defined TASK_MESSAGE_BUFFER
+    #define DEFAULT_TASK_MESSAGE_BUFFER     true
+#else
+    #define DEFAULT_TASK_MESSAGE_BUFFER     false
+#endif
+#if defined TASK_STREAM_BUFFER
+    #define DEFAULT_TASK_STREAM_BUFFER  true
+#else
+    #define DEFAULT_TASK_STREAM_BUFFER  false
+#endif
+#if defined TASK_QUEUE_SET
+    #define DEFAULT_TASK_QUEUE_SET  true
+#else
+    #define DEFAULT_TASK_QUEUE_SET  false
+#endif
+#if defined TASK_TIMER
+    #define DEFAULT_TASK_TIMER  true
+#else
+    #define DEFAULT_TASK_TIMER  false
+#endif
+#if defined TASK_PEND_FUNC_CALL
+    #define DEFAULT_TASK_PEND_FUNC_CALL     true
+#else
+    #define DEFAULT_TASK_PEND_FUNC_CALL     false
+#endif
+#if defined TASK_TIMER_QUERY
+    #define DEFAULT_TASK_TIMER_QUERY    true
+#else
+    #define DEFAULT_TASK_TIMER_QUERY    false
+#endif
+#if defined TEST_DELETE_MUTEX
+    #define DEFAULT_TEST_DELETE_MUTEX   true
+#else
+    #define DEFAULT_TEST_DELETE_MUTEX   false
+#endif
+#if defined TIMER_PERIODIC_ISR_TESTS
+    #define DEFAULT_TIMER_PERIODIC_ISR_TESTS    true
+#else
+    #define DEFAULT_TIMER_PERIODIC_ISR_TESTS    false
+#endif
+#if defined QUEUE_OVERWRITE_PERIODIC_ISR
+    #define DEFAULT_QUEUE_OVERWRITE_PERIODIC_ISR    true
+#else
+    #define DEFAULT_QUEUE_OVERWRITE_PERIODIC_ISR    false
+#endif
+#if defined QUEUE_SET_ACCESS_ISR
+    #define DEFAULT_QUEUE_SET_ACCESS_ISR    true
+#else
+    #define DEFAULT_QUEUE_SET_ACCESS_ISR    false
+#endif
+#if defined QUEUE_SET_ACCESS_POLL_ISR
+    #define DEFAULT_QUEUE_SET_ACCESS_POLL_ISR   true
+#else
+    #define DEFAULT_QUEUE_SET_ACCESS_POLL_ISR   false
+#endif
+#if defined EVENT_GROUP_ISR
+    #define DEFAULT_EVENT_GROUP_ISR     true
+#else
+    #define DEFAULT_EVENT_GROUP_ISR     false
+#endif
+#if defined SEM_TEST_ISR
+    #define DEFAULT_SEM_TEST_ISR    true
+#else
+    #define DEFAULT_SEM_TEST_ISR    false
+#endif
+#if defined NOTIFY_TASK_ISR
+    #define DEFAULT_NOTIFY_TASK_ISR     true
+#else
+    #define DEFAULT_NOTIFY_TASK_ISR     false
+#endif
+#if defined STREAM_BUFFER_SEND_ISR
+    #define DEFAULT_STREAM_BUFFER_SEND_ISR  true
+#else
+    #define DEFAULT_STREAM_BUFFER_SEND_ISR  false
+#endif
+
+// Same order of WorkloadItem
+static WorkloadEntry workload[WORKLOAD_ITEMS_COUNT] = {
+    { "TASK_CHECK", DEFAULT_TASK_CHECK, false, 0 },
+    { "TASK_BLOCKING_QUEUE", DEFAULT_TASK_BLOCKING_QUEUE, false, 0 },
+    { "TASK_SEM_TEST", DEFAULT_TASK_SEM_TEST, false, 0 },
+    { "TASK_POLL_QUEUE", DEFAULT_TASK_POLL_QUEUE, false, 0 },
+    { "TASK_COUNT_SEM", DEFAULT_TASK_COUNT_SEM, false, 0 },
+    { "TASK_EVENT_GROUPS", DEFAULT_TASK_EVENT_GROUPS, false, 0 },
+    { "TASK_QUEUE_SPACE_AVAIL", DEFAULT_TASK_QUEUE_SPACE_AVAIL, false, 0 },
+    { "TASK_INDEF_DELAY_SEM", DEFAULT_TASK_INDEF_DELAY_SEM, false, 0 },
+    { "TASK_INDEF_DELAY_NOTIF", DEFAULT_TASK_INDEF_DELAY_NOTIF, false, 0 },
+    { "TASK_MESSAGE_BUFFER", DEFAULT_TASK_MESSAGE_BUFFER, false, 0 },
+    { "TASK_STREAM_BUFFER", DEFAULT_TASK_STREAM_BUFFER, false, 0 },
+    { "TASK_QUEUE_SET", DEFAULT_TASK_QUEUE_SET, false, 0 },
+    { "TASK_TIMER", DEFAULT_TASK_TIMER, false, 0 },
+    { "TASK_PEND_FUNC_CALL", DEFAULT_TASK_PEND_FUNC_CALL, false, 0 },
+    { "TASK_TIMER_QUERY", DEFAULT_TASK_TIMER_QUERY, false, 0 },
+    { "TEST_DELETE_MUTEX", DEFAULT_TEST_DELETE_MUTEX, false, 0 },
+    { "TIMER_PERIODIC_ISR_TESTS", DEFAULT_TIMER_PERIODIC_ISR_TESTS, false, 0 },
+    { "QUEUE_OVERWRITE_PERIODIC_ISR", DEFAULT_QUEUE_OVERWRITE_PERIODIC_ISR, false, 0 },
+    { "QUEUE_SET_ACCESS_ISR", DEFAULT_QUEUE_SET_ACCESS_ISR, false, 0 },
+    { "QUEUE_SET_ACCESS_POLL_ISR", DEFAULT_QUEUE_SET_ACCESS_POLL_ISR, false, 0 },
+    { "EVENT_GROUP_ISR", DEFAULT_EVENT_GROUP_ISR, false, 0 },
+    { "SEM_TEST_ISR", DEFAULT_SEM_TEST_ISR, false, 0 },
+    { "NOTIFY_TASK_ISR", DEFAULT_NOTIFY_TASK_ISR, false, 0 },
+    { "STREAM_BUFFER_SEND_ISR", DEFAULT_STREAM_BUFFER_SEND_ISR, false, 0 }
+};
+
+static int cycles = CHECK_TASK_CYCLES;
+static unsigned long period_ticks = CHECK_TASK_PERIOD_TICKS;
+
+static void invalid_manifest(const std::string& manifest, const std::string& reason) {
+    std::cerr << "Invalid workload manifest \"" << manifest << "\": " << reason << std::endl;
+    exit(1);
+}
+
+static unsigned long parse_positive(const std::string& manifest, const std::string& item, size_t value_pos) {
+    char* end;
+    unsigned long value = strtoul(item.c_str() + value_pos, &end, 10);
+
+    if (*end != '\0' || value == 0)
+        invalid_manifest(manifest, item.substr(0, value_pos - 1) + " must be a number greater than 0");
+    return value;
+}
+
+/*
+* The manifest is a comma separated list of the enabled items, each one optionally
+* followed by the priority of its tasks, plus the timing of the run:
+*   TASK_CHECK,TASK_BLOCKING_QUEUE:2,TASK_SEM_TEST,period=2000,cycles=3
+*   - period=<ticks>: period of the check task
+*   - cycles=<n>:     number of check cycles after which the simulator exits
+*   - length=<ticks>: run length, rounded up to a whole number of check periods (overrides cycles)
+*   - profile=short:  short run (see WORKLOAD_PROFILE_SHORT), applied first wherever it is listed:
+*                     the other entries override it
+* If no item is listed the items of the build are kept, otherwise the items not listed are disabled.
+*/
+static void parse_manifest(const std::string& manifest) {
+    std::stringstream ss(manifest);
+    std::string item;
+    bool listed[WORKLOAD_ITEMS_COUNT] = { false };
+    bool items_listed = false;
+    unsigned long length_ticks = 0;
+
+    // The profile first, the timing entries override it
+    while (std::getline(ss, item, ',')) {
+        if (item.compare(0, 8, "profile=") != 0)
+            continue;
+        if (item.substr(8) != WORKLOAD_PROFILE_SHORT)
+            invalid_manifest(manifest, "unknown profile " + item.substr(8));
+        period_ticks = WORKLOAD_SHORT_PERIOD_TICKS;
+        cycles = WORKLOAD_SHORT_CYCLES;
+    }
+
+    ss.clear();
+    ss.str(manifest);
+    while (std::getline(ss, item, ',')) {
+        if (item == "")
+            continue;
+
+        if (item.compare(0, 7, "cycles=") == 0) {
+            cycles = (int)parse_positive(manifest, item, 7);
+            continue;
+        }
+        if (item.compare(0, 7, "period=") == 0) {
+            period_ticks = parse_positive(manifest, item, 7);
+            continue;
+        }
+        if (item.compare(0, 7, "length=") == 0) {
+            length_ticks = parse_positive(manifest, item, 7);
+            continue;
+        }
+        if (item.compare(0, 8, "profile=") == 0)
+            continue;
+
+        std::string name = item.substr(0, item.find(':'));
+        int i;
+        for (i = 0; i < WORKLOAD_ITEMS_COUNT; i++) {
+            if (name == workload[i].name)
+                break;
+        }
+        if (i == WORKLOAD_ITEMS_COUNT)
+            invalid_manifest(manifest, "unknown item " + name);
+
+        listed[i] = true;
+        items_listed = true;
+        if (name.size() < item.size()) {
+            workload[i].priority_set = true;
+            workload[i].priority = strtoul(item.c_str() + name.size() + 1, NULL, 10);
+        }
+    }
+
+    if (items_listed) {
+        for (int i = 0; i < WORKLOAD_ITEMS_COUNT; i++)
+            workload[i].enabled = listed[i];
+    }
+
+    if (length_ticks > 0)
+        cycles = (int)((length_ticks + period_ticks - 1) / period_ticks);
+}
+
+void workload_init(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], WORKLOAD_ARG) == 0) {
+            if (i + 1 == argc)
+                invalid_manifest("", "missing after " WORKLOAD_ARG);
+            parse_manifest(argv[i + 1]);
+            i++;
+        }
+    }
+}
+
+int workload_enabled(int item) {
+    return workload[item].enabled;
+}
+
+unsigned long workload_get_priority(int item, unsigned long default_priority) {
+    return workload[item].priority_set ? workload[item].priority : default_priority;
+}
+
+int workload_get_cycles(void) {
+    return cycles;
+}
+
+unsigned long workload_get_period_ticks(void) {
+    return period_ticks;
+}
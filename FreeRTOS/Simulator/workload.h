@@ -0,0 +1,63 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+/* Command line option followed by the workload manifest */
+#define WORKLOAD_ARG        "--workload"
+
+/*
+* The parts of the simulator workload that can be selected at startup.
+* Their names in the manifest are the names of the corresponding CMake options,
+* whose values are the defaults used when no manifest is given.
+*/
+enum WorkloadItem {
+    WORKLOAD_TASK_CHECK,
+    WORKLOAD_TASK_BLOCKING_QUEUE,
+    WORKLOAD_TASK_SEM_TEST,
+    WORKLOAD_TASK_POLL_QUEUE,
+    WORKLOAD_TASK_COUNT_SEM,
+    WORKLOAD_TASK_EVENT_GROUPS,
+    WORKLOAD_TASK_QUEUE_SPACE_AVAIL,
+    WORKLOAD_TASK_INDEF_DELAY_SEM,
+    WORKLOAD_TASK_INDEF_DELAY_NOTIF,
+    WORKLOAD_TASK_MESSAGE_BUFFER,
+    WORKLOAD_TASK_STREAM_BUFFER,
+    WORKLOAD_TASK_QUEUE_SET,
+    WORKLOAD_TASK_TIMER,
+    WORKLOAD_TASK_PEND_FUNC_CALL,
+    WORKLOAD_TASK_TIMER_QUERY,
+    WORKLOAD_TEST_DELETE_MUTEX,
+    WORKLOAD_TIMER_PERIODIC_ISR_TESTS,
+    WORKLOAD_QUEUE_OVERWRITE_PERIODIC_ISR,
+    WORKLOAD_QUEUE_SET_ACCESS_ISR,
+    WORKLOAD_QUEUE_SET_ACCESS_POLL_ISR,
+    WORKLOAD_EVENT_GROUP_ISR,
+    WORKLOAD_SEM_TEST_ISR,
+    WORKLOAD_NOTIFY_TASK_ISR,
+    WORKLOAD_STREAM_BUFFER_SEND_ISR,
+    WORKLOAD_ITEMS_COUNT
+};
+
+/*
+* "short" profile: the check period is the longest time a demo task blocks for, i.e. the timers test
+* (TimerDemo, configTIMER_QUEUE_LENGTH times its base period of 50 ticks: 1000 ticks), so that the check
+* task sees every task progress in each cycle, and the run lasts 3 s instead of 30 s.
+*/
+#define WORKLOAD_PROFILE_SHORT              "short"
+#define WORKLOAD_SHORT_PERIOD_TICKS         1000
+#define WORKLOAD_SHORT_CYCLES               3
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void workload_init(int argc, char **argv);
+    int workload_enabled(int item);
+    unsigned long workload_get_priority(int item, unsigned long default_priority);
+    int workload_get_cycles(void);
+    unsigned long workload_get_period_ticks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORKLOAD_H */